@@ -1,4 +1,6 @@
 #pragma once
+#include <array>
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -16,6 +18,36 @@
 
 using namespace std;
 
+// Статистика отрисовки: кадры, вызовы рисования SDL и время кадра (для сравнения частичной и полной перерисовки)
+struct frame_stats
+{
+    uint64_t frames = 0;     // Показанные кадры
+    uint64_t full = 0;       // Из них кадры с полной перерисовкой
+    uint64_t cells = 0;      // Перерисованные клетки
+    uint64_t draw_calls = 0; // Вызовы SDL_RenderCopy / SDL_RenderFillRect / SDL_RenderClear
+    double total_ms = 0;     // Суммарное время кадров
+    double max_ms = 0;       // Самый долгий кадр
+};
+
+/**
+ * Шаг истории: перемещение фигуры и все, что нужно для его отмены (9 байт вместо копии доски).
+ * Ход со взятием нескольких фигур записывается несколькими шагами с растущим beat_series
+ */
+struct history_step
+{
+    POS_T x, y, x2, y2;        // Откуда и куда
+    POS_T xb = -1, yb = -1;    // Побитая фигура (-1 - ход без взятия)
+    POS_T beaten = 0;          // Тип побитой фигуры (для отмены)
+    bool promoted = false;     // Шашка стала дамкой на этом шаге
+    uint8_t beat_series = 0;   // Номер шага в серии взятий (0 - ход без взятия)
+};
+
+/**
+ * Доска. Изменения (ходы, подсветка, выделение) только запоминаются, а рисует их flush() одним кадром:
+ * кадр собирается в текстуре-цели, где перерисовываются лишь клетки, отличающиеся от уже нарисованных.
+ * Фон доски с кнопками хранится в отдельной текстуре, из нее восстанавливается фон клетки.
+ * flush() вызывает Hand перед ожиданием событий
+ */
 class Board
 {
 public:
@@ -57,8 +89,9 @@ public:
             return 1;
         }
         
-        // Создание рендерера с аппаратным ускорением и вертикальной синхронизацией
-        ren = SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+        // Создание рендерера с аппаратным ускорением, вертикальной синхронизацией и текстурами-целями
+        ren = SDL_CreateRenderer(win, -1,
+                                 SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_TARGETTEXTURE);
         if (ren == nullptr)
         {
             print_exception("SDL_CreateRenderer can't create renderer");
@@ -73,9 +106,14 @@ public:
         b_queen = IMG_LoadTexture(ren, queen_black_path.c_str());
         back = IMG_LoadTexture(ren, back_path.c_str());
         replay = IMG_LoadTexture(ren, replay_path.c_str());
+        // Картинки результата загружаются один раз, а не при каждой отрисовке финального экрана
+        white_wins = IMG_LoadTexture(ren, white_path.c_str());
+        black_wins = IMG_LoadTexture(ren, black_path.c_str());
+        draw_result = IMG_LoadTexture(ren, draw_path.c_str());
         
         // Проверка успешной загрузки текстур
-        if (!board || !w_piece || !b_piece || !w_queen || !b_queen || !back || !replay)
+        if (!board || !w_piece || !b_piece || !w_queen || !b_queen || !back || !replay || !white_wins ||
+            !black_wins || !draw_result)
         {
             print_exception("IMG_LoadTexture can't load main textures from " + textures_path);
             return 1;
@@ -84,7 +122,9 @@ public:
         // Получение актуальных размеров рендерера
         SDL_GetRendererOutputSize(ren, &W, &H);
         make_start_mtx(); // Создание начальной расстановки фигур
-        rerender();       // Первоначальная отрисовка
+        full_redraw = true;
+        rerender();
+        flush();          // Первоначальная отрисовка
         return 0;
     }
 
@@ -92,8 +132,6 @@ public:
     void redraw()
     {
         game_results = -1;
-        history_mtx.clear();
-        history_beat_series.clear();
         make_start_mtx();
         clear_active();
         clear_highlight();
@@ -102,35 +140,17 @@ public:
     // Перемещение фигуры с использованием структуры move_pos
     void move_piece(move_pos turn, const int beat_series = 0)
     {
-        // Если ход включает взятие - удаляем побитую фигуру
-        if (turn.xb != -1)
-        {
-            mtx[turn.xb][turn.yb] = 0;
-        }
-        move_piece(turn.x, turn.y, turn.x2, turn.y2, beat_series);
+        history_step step{turn.x, turn.y, turn.x2, turn.y2, turn.xb, turn.yb};
+        step.beat_series = uint8_t(beat_series);
+        make_step(step);
     }
 
     // Основной метод перемещения фигуры с проверками
     void move_piece(const POS_T i, const POS_T j, const POS_T i2, const POS_T j2, const int beat_series = 0)
     {
-        // Проверка что конечная позиция свободна
-        if (mtx[i2][j2])
-        {
-            throw runtime_error("final position is not empty, can't move");
-        }
-        // Проверка что начальная позиция содержит фигуру
-        if (!mtx[i][j])
-        {
-            throw runtime_error("begin position is empty, can't move");
-        }
-        // Проверка превращения в дамку (для белых - первая линия, для черных - последняя)
-        if ((mtx[i][j] == 1 && i2 == 0) || (mtx[i][j] == 2 && i2 == 7))
-            mtx[i][j] += 2;
-            
-        // Выполнение перемещения
-        mtx[i2][j2] = mtx[i][j];
-        drop_piece(i, j);
-        add_history(beat_series); // Сохранение состояния в историю
+        history_step step{i, j, i2, j2};
+        step.beat_series = uint8_t(beat_series);
+        make_step(step);
     }
 
     // Удаление фигуры с доски
@@ -203,18 +223,53 @@ public:
     // Отмена последнего хода (откат)
     void rollback()
     {
-        auto beat_series = max(1, *(history_beat_series.rbegin()));
-        // Удаление из истории с учетом серии взятий
-        while (beat_series-- && history_mtx.size() > 1)
+        if (history.empty())
+            return;
+        int beat_series = max(1, int(history.back().beat_series));
+        // Отмена шагов с конца журнала с учетом серии взятий
+        while (beat_series-- && !history.empty())
         {
-            history_mtx.pop_back();
-            history_beat_series.pop_back();
+            undo_step(mtx, history.back());
+            history.pop_back();
         }
-        mtx = *(history_mtx.rbegin()); // Восстановление предыдущего состояния
+        if (snapshots.size() > history.size() / SNAPSHOT_INTERVAL + 1)
+            snapshots.resize(history.size() / SNAPSHOT_INTERVAL + 1);
         clear_highlight();
         clear_active();
     }
 
+    // Число шагов в истории (0 - отменять нечего)
+    size_t history_size() const
+    {
+        return history.size();
+    }
+
+    // Журнал шагов с начала партии (для реплея и сохранения партии)
+    const vector<history_step> &get_history() const
+    {
+        return history;
+    }
+
+    // Доска после первых ply шагов истории: ближайший снимок и не больше SNAPSHOT_INTERVAL шагов после него
+    vector<vector<POS_T>> board_at(size_t ply) const
+    {
+        ply = min(ply, history.size());
+        const size_t snapshot = ply / SNAPSHOT_INTERVAL;
+        vector<vector<POS_T>> res(8, vector<POS_T>(8, 0));
+        for (POS_T i = 0; i < 8; ++i)
+            for (POS_T j = 0; j < 8; ++j)
+                res[i][j] = snapshots[snapshot][i * 8 + j];
+        for (size_t k = snapshot * SNAPSHOT_INTERVAL; k < ply; ++k)
+            redo_step(res, history[k]);
+        return res;
+    }
+
+    // Строка состояния в заголовке окна (например, сводка поиска бота); пустая - только название игры
+    void set_status(const string &text)
+    {
+        SDL_SetWindowTitle(win, text.empty() ? "Checkers" : ("Checkers - " + text).c_str());
+    }
+
     // Отображение финального экрана с результатом игры
     void show_final(const int res)
     {
@@ -222,13 +277,70 @@ public:
         rerender();
     }
 
-    // Сброс размеров окна (при изменении пользователем)
+    // Сброс размеров окна (при изменении пользователем или потере текстур-целей): кадр рисуется заново
     void reset_window_size()
     {
         SDL_GetRendererOutputSize(ren, &W, &H);
+        full_redraw = true;
         rerender();
     }
 
+    /**
+     * Рисует накопленные изменения одним кадром. Перерисовываются только клетки, у которых изменились
+     * фигура, подсветка или выделение; весь кадр - в начале, после изменения размера окна и рестарта
+     */
+    void flush()
+    {
+        if (!frame_pending || !ren)
+            return;
+        frame_pending = false;
+        const auto start = chrono::steady_clock::now();
+        const bool full = full_redraw || !frame || !base;
+        if (full && !make_frame_textures())
+            return;
+        full_redraw = false;
+
+        SDL_SetRenderTarget(ren, frame);
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                const bool active = i == active_x && j == active_y;
+                const bool was_active = i == drawn_active_x && j == drawn_active_y;
+                if (!full && mtx[i][j] == drawn_mtx[i][j] && is_highlighted_[i][j] == drawn_highlighted[i][j] &&
+                    active == was_active)
+                    continue;
+                draw_cell(i, j, !full);
+                ++stats.cells;
+            }
+        }
+        drawn_mtx = mtx;
+        drawn_highlighted = is_highlighted_;
+        drawn_active_x = active_x;
+        drawn_active_y = active_y;
+
+        // Кадр на экран, поверх него - результат игры
+        SDL_SetRenderTarget(ren, nullptr);
+        copy(frame, nullptr, nullptr);
+        if (game_results != -1)
+        {
+            SDL_Texture *result_texture = draw_result;
+            if (game_results == 1)
+                result_texture = white_wins;
+            else if (game_results == 2)
+                result_texture = black_wins;
+            SDL_Rect res_rect{ W / 5, H * 3 / 10, W * 3 / 5, H * 2 / 5 };
+            copy(result_texture, nullptr, &res_rect);
+        }
+        SDL_RenderPresent(ren);
+
+        const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        ++stats.frames;
+        stats.full += full;
+        stats.total_ms += ms;
+        stats.max_ms = max(stats.max_ms, ms);
+    }
+
     // Очистка ресурсов SDL
     void quit()
     {
@@ -239,6 +351,11 @@ public:
         SDL_DestroyTexture(b_queen);
         SDL_DestroyTexture(back);
         SDL_DestroyTexture(replay);
+        SDL_DestroyTexture(white_wins);
+        SDL_DestroyTexture(black_wins);
+        SDL_DestroyTexture(draw_result);
+        SDL_DestroyTexture(base);
+        SDL_DestroyTexture(frame);
         SDL_DestroyRenderer(ren);
         SDL_DestroyWindow(win);
         SDL_Quit();
@@ -251,11 +368,59 @@ public:
     }
 
 private:
-    // Добавление текущего состояния в историю
-    void add_history(const int beat_series = 0)
+    // Выполнение шага с проверками и запись его в журнал
+    void make_step(history_step step)
+    {
+        // Проверка что конечная позиция свободна
+        if (mtx[step.x2][step.y2])
+        {
+            throw runtime_error("final position is not empty, can't move");
+        }
+        // Проверка что начальная позиция содержит фигуру
+        if (!mtx[step.x][step.y])
+        {
+            throw runtime_error("begin position is empty, can't move");
+        }
+        if (step.xb != -1)
+            step.beaten = mtx[step.xb][step.yb];
+        // Проверка превращения в дамку (для белых - первая линия, для черных - последняя)
+        const POS_T piece = mtx[step.x][step.y];
+        step.promoted = (piece == 1 && step.x2 == 0) || (piece == 2 && step.x2 == 7);
+
+        redo_step(mtx, step);
+        rerender();
+        history.push_back(step);
+        // Снимок доски каждые SNAPSHOT_INTERVAL шагов, чтобы board_at не проигрывал всю партию
+        if (history.size() % SNAPSHOT_INTERVAL == 0)
+            add_snapshot();
+    }
+
+    // Повтор шага на доске m
+    static void redo_step(vector<vector<POS_T>> &m, const history_step &step)
+    {
+        if (step.xb != -1)
+            m[step.xb][step.yb] = 0;
+        m[step.x2][step.y2] = m[step.x][step.y] + (step.promoted ? 2 : 0);
+        m[step.x][step.y] = 0;
+    }
+
+    // Отмена шага на доске m
+    static void undo_step(vector<vector<POS_T>> &m, const history_step &step)
+    {
+        m[step.x][step.y] = m[step.x2][step.y2] - (step.promoted ? 2 : 0);
+        m[step.x2][step.y2] = 0;
+        if (step.xb != -1)
+            m[step.xb][step.yb] = step.beaten;
+    }
+
+    // Снимок текущей доски (снимок k - доска после k * SNAPSHOT_INTERVAL шагов)
+    void add_snapshot()
     {
-        history_mtx.push_back(mtx);
-        history_beat_series.push_back(beat_series);
+        array<POS_T, 64> snapshot;
+        for (POS_T i = 0; i < 8; ++i)
+            for (POS_T j = 0; j < 8; ++j)
+                snapshot[i * 8 + j] = mtx[i][j];
+        snapshots.push_back(snapshot);
     }
     
     // Создание начальной расстановки фигур
@@ -274,100 +439,117 @@ private:
                     mtx[i][j] = 1;
             }
         }
-        add_history(); // Сохранение начального состояния
+        // Новая партия: журнал пуст, начальная расстановка - нулевой снимок
+        history.clear();
+        snapshots.clear();
+        add_snapshot();
     }
 
-    // Основная функция перерисовки всего игрового поля
+    // Запрос перерисовки: изменения копятся до flush(), поэтому несколько изменений за клик дают один кадр
     void rerender()
     {
-        // Очистка рендерера и отрисовка доски
-        SDL_RenderClear(ren);
-        SDL_RenderCopy(ren, board, NULL, NULL);
+        frame_pending = true;
+    }
 
-        // Отрисовка всех фигур на доске
-        for (POS_T i = 0; i < 8; ++i)
+    // Счетчик вызовов рисования для статистики
+    void copy(SDL_Texture *texture, const SDL_Rect *src, const SDL_Rect *dst)
+    {
+        SDL_RenderCopy(ren, texture, src, dst);
+        ++stats.draw_calls;
+    }
+
+    // Прямоугольник клетки (i, j) на экране
+    SDL_Rect cell_rect(const int i, const int j) const
+    {
+        const int x = W * (j + 1) / 10, y = H * (i + 1) / 10;
+        return SDL_Rect{ x, y, W * (j + 2) / 10 - x, H * (i + 2) / 10 - y };
+    }
+
+    /**
+     * Пересоздает текстуры под текущий размер окна и рисует фон: доску и кнопки.
+     * Кадр начинается с копии фона, клетки затем рисуются поверх
+     */
+    bool make_frame_textures()
+    {
+        int tw = 0, th = 0;
+        if (frame)
+            SDL_QueryTexture(frame, nullptr, nullptr, &tw, &th);
+        if (!frame || !base || tw != W || th != H)
         {
-            for (POS_T j = 0; j < 8; ++j)
+            SDL_DestroyTexture(base);
+            SDL_DestroyTexture(frame);
+            base = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, W, H);
+            frame = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, W, H);
+            if (!base || !frame)
             {
-                if (!mtx[i][j])
-                    continue;
-                // Расчет позиции фигуры на экране
-                int wpos = W * (j + 1) / 10 + W / 120;
-                int hpos = H * (i + 1) / 10 + H / 120;
-                SDL_Rect rect{ wpos, hpos, W / 12, H / 12 };
-
-                // Выбор текстуры в зависимости от типа фигуры
-                SDL_Texture* piece_texture;
-                if (mtx[i][j] == 1)
-                    piece_texture = w_piece;
-                else if (mtx[i][j] == 2)
-                    piece_texture = b_piece;
-                else if (mtx[i][j] == 3)
-                    piece_texture = w_queen;
-                else
-                    piece_texture = b_queen;
-
-                SDL_RenderCopy(ren, piece_texture, NULL, &rect);
+                print_exception("SDL_CreateTexture can't create frame textures");
+                return false;
             }
         }
+        SDL_SetRenderTarget(ren, base);
+        SDL_RenderClear(ren);
+        ++stats.draw_calls;
+        copy(board, nullptr, nullptr);
+        // Отрисовка кнопок интерфейса (назад и рестарт)
+        SDL_Rect rect_left{ W / 40, H / 40, W / 15, H / 15 };
+        copy(back, nullptr, &rect_left);
+        SDL_Rect replay_rect{ W * 109 / 120, H / 40, W / 15, H / 15 };
+        copy(replay, nullptr, &replay_rect);
+        SDL_SetRenderTarget(ren, frame);
+        copy(base, nullptr, nullptr);
+        return true;
+    }
 
-        // Отрисовка подсвеченных клеток (зеленый контур)
-        SDL_SetRenderDrawColor(ren, 0, 255, 0, 0);
-        const double scale = 2.5;
-        SDL_RenderSetScale(ren, scale, scale);
-        for (POS_T i = 0; i < 8; ++i)
+    // Рисует клетку (i, j) в кадре: фон из base (restore), фигура, подсветка (зеленый контур) и выделение (красный)
+    void draw_cell(const POS_T i, const POS_T j, const bool restore)
+    {
+        const SDL_Rect cell = cell_rect(i, j);
+        if (restore)
+            copy(base, &cell, &cell);
+        if (mtx[i][j])
         {
-            for (POS_T j = 0; j < 8; ++j)
-            {
-                if (!is_highlighted_[i][j])
-                    continue;
-                SDL_Rect cell{ int(W * (j + 1) / 10 / scale), int(H * (i + 1) / 10 / scale), int(W / 10 / scale),
-                              int(H / 10 / scale) };
-                SDL_RenderDrawRect(ren, &cell);
-            }
+            // Расчет позиции фигуры на экране (фигура целиком внутри клетки)
+            int wpos = W * (j + 1) / 10 + W / 120;
+            int hpos = H * (i + 1) / 10 + H / 120;
+            SDL_Rect rect{ wpos, hpos, W / 12, H / 12 };
+
+            // Выбор текстуры в зависимости от типа фигуры
+            SDL_Texture* piece_texture;
+            if (mtx[i][j] == 1)
+                piece_texture = w_piece;
+            else if (mtx[i][j] == 2)
+                piece_texture = b_piece;
+            else if (mtx[i][j] == 3)
+                piece_texture = w_queen;
+            else
+                piece_texture = b_queen;
+            copy(piece_texture, nullptr, &rect);
         }
-
-        // Отрисовка активной клетки (красный контур)
-        if (active_x != -1)
+        if (i == active_x && j == active_y)
         {
             SDL_SetRenderDrawColor(ren, 255, 0, 0, 0);
-            SDL_Rect active_cell{ int(W * (active_y + 1) / 10 / scale), int(H * (active_x + 1) / 10 / scale),
-                                 int(W / 10 / scale), int(H / 10 / scale) };
-            SDL_RenderDrawRect(ren, &active_cell);
+            draw_frame(cell);
         }
-        SDL_RenderSetScale(ren, 1, 1);
-
-        // Отрисовка кнопок интерфейса (назад и рестарт)
-        SDL_Rect rect_left{ W / 40, H / 40, W / 15, H / 15 };
-        SDL_RenderCopy(ren, back, NULL, &rect_left);
-        SDL_Rect replay_rect{ W * 109 / 120, H / 40, W / 15, H / 15 };
-        SDL_RenderCopy(ren, replay, NULL, &replay_rect);
-
-        // Отрисовка результата игры если игра завершена
-        if (game_results != -1)
+        else if (is_highlighted_[i][j])
         {
-            string result_path = draw_path;
-            if (game_results == 1)
-                result_path = white_path;
-            else if (game_results == 2)
-                result_path = black_path;
-            SDL_Texture* result_texture = IMG_LoadTexture(ren, result_path.c_str());
-            if (result_texture == nullptr)
-            {
-                print_exception("IMG_LoadTexture can't load game result picture from " + result_path);
-                return;
-            }
-            SDL_Rect res_rect{ W / 5, H * 3 / 10, W * 3 / 5, H * 2 / 5 };
-            SDL_RenderCopy(ren, result_texture, NULL, &res_rect);
-            SDL_DestroyTexture(result_texture);
+            SDL_SetRenderDrawColor(ren, 0, 255, 0, 0);
+            draw_frame(cell);
         }
+    }
 
-        // Обновление экрана
-        SDL_RenderPresent(ren);
-        // Обработка событий для поддержания отзывчивости интерфейса
-        SDL_Delay(10);
-        SDL_Event windowEvent;
-        SDL_PollEvent(&windowEvent);
+    // Контур по краю клетки изнутри (не выходит за клетку, поэтому клетки перерисовываются независимо)
+    void draw_frame(const SDL_Rect &cell)
+    {
+        const int t = 3;
+        const SDL_Rect sides[4] = {{cell.x, cell.y, cell.w, t},
+                                   {cell.x, cell.y + cell.h - t, cell.w, t},
+                                   {cell.x, cell.y, t, cell.h},
+                                   {cell.x + cell.w - t, cell.y, t, cell.h}};
+        for (const auto &side : sides)
+        {
+            SDL_RenderFillRect(ren, &side);
+            ++stats.draw_calls;
+        }
     }
 
     // Логирование ошибок в файл
@@ -380,8 +562,7 @@ private:
   public:
     int W = 0;  // Ширина окна
     int H = 0;  // Высота окна
-    // История состояний доски для реализации отмены ходов
-    vector<vector<vector<POS_T>>> history_mtx;
+    frame_stats stats; // Статистика отрисовки (сбрасывает владелец, например после каждого хода)
 
   private:
     SDL_Window *win = nullptr;      // Указатель на окно SDL
@@ -395,6 +576,11 @@ private:
     SDL_Texture *b_queen = nullptr;  // Черная дамка
     SDL_Texture *back = nullptr;     // Кнопка "Назад"
     SDL_Texture *replay = nullptr;   // Кнопка "Рестарт"
+    SDL_Texture *white_wins = nullptr;  // Результат: победа белых
+    SDL_Texture *black_wins = nullptr;  // Результат: победа черных
+    SDL_Texture *draw_result = nullptr; // Результат: ничья
+    SDL_Texture *base = nullptr;     // Фон кадра: доска и кнопки под текущий размер окна
+    SDL_Texture *frame = nullptr;    // Собранный кадр (текстура-цель)
     
     // Пути к файлам текстур
     const string textures_path = project_path + "Textures/";
@@ -418,6 +604,15 @@ private:
     // Матрица состояния доски: 
     // 0 - пусто, 1 - белая шашка, 2 - черная шашка, 3 - белая дамка, 4 - черная дамка
     vector<vector<POS_T>> mtx = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
-    // История серий взятий для корректного отката ходов
-    vector<int> history_beat_series;
+    // История партии для отмены ходов и реплея: журнал шагов и снимки доски каждые SNAPSHOT_INTERVAL шагов
+    static constexpr size_t SNAPSHOT_INTERVAL = 64;
+    vector<history_step> history;
+    vector<array<POS_T, 64>> snapshots;
+
+    // Состояние, уже нарисованное в кадре: с ним flush() сравнивает текущее, чтобы найти измененные клетки
+    bool frame_pending = false; // Есть изменения, не показанные на экране
+    bool full_redraw = true;    // Следующий кадр рисуется целиком
+    vector<vector<POS_T>> drawn_mtx = vector<vector<POS_T>>(8, vector<POS_T>(8, 0));
+    vector<vector<bool>> drawn_highlighted = vector<vector<bool>>(8, vector<bool>(8, 0));
+    int drawn_active_x = -1, drawn_active_y = -1;
 };
@@ -1,7 +1,9 @@
 #pragma once
 #include <fstream>
+#include <string>
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
+using namespace std;
 
 #include "../Models/Project_path.h"
 
@@ -13,9 +15,15 @@ class Config
         reload();
     }
 
+    // Настройки из произвольного файла (например, разные конфигурации ботов в консольных утилитах)
+    explicit Config(const string &path) : path(path)
+    {
+        reload();
+    }
+
     void reload()
     {
-        std::ifstream fin(project_path + "settings.json");
+        std::ifstream fin(path);
         fin >> config;
         fin.close();
     }
@@ -25,6 +33,13 @@ class Config
         return config[setting_dir][setting_name];
     }
 
+    // Переопределение параметра в памяти, без записи в settings.json (для консольных утилит)
+    template <class T> void set(const string &setting_dir, const string &setting_name, const T &value)
+    {
+        config[setting_dir][setting_name] = value;
+    }
+
   private:
+    string path = project_path + "settings.json";
     json config;
 };
@@ -1,6 +1,103 @@
+/**
+ * Хеши позиций партии (Position::key) с последнего необратимого хода (взятия, хода шашкой)
+ * до текущей позиции, где ходит color, без нее. Восстанавливаются по журналу ходов доски:
+ * обратимый ход - один шаг дамкой без взятия
+ */
+vector<uint64_t> game_history(bool color)
+{
+    vector<uint64_t> keys;
+    const vector<history_step> &steps = board.get_history();
+    for (size_t k = steps.size(); k > 0; --k)
+    {
+        const history_step &step = steps[k - 1];
+        if (step.xb != -1 || step.promoted)
+            break;
+        const vector<vector<POS_T>> before = board.board_at(k - 1);
+        if (before[step.x][step.y] < 3)
+            break;
+        color = !color;
+        keys.push_back(Position(before).key(color));
+    }
+    reverse(keys.begin(), keys.end());
+    return keys;
+}
+
+/**
+ * Ход бота. Поиск идет в отдельном потоке, а главный поток продолжает обрабатывать события окна,
+ * поэтому во время долгого поиска окно отвечает. QUIT, BACK и REPLAY отменяют поиск
+ * (он проверяет флаг отмены раз в 1024 узла) и возвращаются вызывающему, как из player_turn.
+ * Если соперник сыграл предсказанный ход, продолжается поиск, начатый в его ход (Ponder)
+ */
+Response bot_turn(const bool color)
+{
+    auto start = chrono::steady_clock::now();
+    const int delay_ms = config("Bot", "BotDelayMS");
+
+    const bool show_stats = config("Bot", "ShowSearchStats");
+
+    // Позиция снимается с доски в главном потоке, поток поиска с доской не работает.
+    // Поток поиска будит ожидание событий после каждой итерации и в конце поиска
+    // (notify задается один раз, до первого фонового поиска: позже его может читать размышление)
+    const Position position(board.get_board());
+    if (!logic.notify)
+        logic.notify = [](const int depth) { Hand::wake(depth); };
+    if (!logic.ponder_hit(position, color))
+        logic.start_search(position, color, game_history(color));
+    // Ждем конца поиска, но не меньше BotDelayMS
+    const auto min_end = start + chrono::milliseconds(delay_ms);
+    Response resp = hand.wait_until([&]() { return logic.search_done() && chrono::steady_clock::now() >= min_end; },
+                                    [&](const int depth) {
+                                        if (show_stats && depth > 0)
+                                            board.set_status("thinking, depth " + to_string(depth));
+                                    });
+    if (resp != Response::OK)
+    {
+        logic.stop_search();
+        return resp;
+    }
+    const vector<move_pos> turns = logic.search_result();
+    if (show_stats)
+        board.set_status(logic.last_search.summary());
+
+    // Шаги серии взятий показываются с паузой BotDelayMS, окно при этом тоже отвечает
+    bool is_first = true;
+    for (auto turn : turns)
+    {
+        if (!is_first)
+        {
+            const auto step_end = chrono::steady_clock::now() + chrono::milliseconds(delay_ms);
+            resp = hand.wait_until([&]() { return chrono::steady_clock::now() >= step_end; });
+            if (resp != Response::OK)
+                return resp;
+        }
+        is_first = false;
+        beat_series += (turn.xb != -1);
+        board.move_piece(turn, beat_series);
+    }
+
+    auto end = chrono::steady_clock::now();
+    ofstream fout(project_path + "log.txt", ios_base::app);
+    fout << "Bot turn time: " << (int)chrono::duration<double, milli>(end - start).count() << " millisec\n";
+    // Отрисовка с прошлого хода бота (ход игрока и этот ход)
+    const frame_stats &frames = board.stats;
+    fout << "Frames: " << frames.frames << " (" << frames.full << " full), cells " << frames.cells << ", draw calls "
+         << frames.draw_calls << ", frame time avg " << (frames.frames ? frames.total_ms / frames.frames : 0)
+         << " ms, max " << frames.max_ms << " ms\n";
+    fout.close();
+    board.stats = frame_stats();
+    return Response::OK;
+}
+
 Response player_turn(const bool color)
 {
     // return 1 if quit
+
+    // Пока игрок думает, бот-соперник ищет ответ на его ожидаемый ход
+    if (config("Bot", "Ponder") && config("Bot", color ? "IsWhiteBot" : "IsBlackBot"))
+    {
+        logic.Max_depth = config("Bot", color ? "WhiteBotLevel" : "BlackBotLevel");
+        logic.ponder(Position(board.get_board()), color, game_history(color));
+    }
     
     // Собираем все начальные позиции возможных ходов для подсветки
     vector<pair<POS_T, POS_T>> cells;
@@ -20,9 +117,12 @@ Response player_turn(const bool color)
     {
         // Ожидаем выбора клетки от пользователя
         auto resp = hand.get_cell();
-        // Если получен не CELL ответ (QUIT, BACK, etc.) - возвращаем его
+        // Если получен не CELL ответ (QUIT, BACK, etc.) - останавливаем размышление бота и возвращаем его
         if (get<0>(resp) != Response::CELL)
+        {
+            logic.stop_search();
             return get<0>(resp);
+        }
             
         // Преобразуем ответ в координаты клетки
         pair<POS_T, POS_T> cell{get<1>(resp), get<2>(resp)};
@@ -122,7 +222,10 @@ Response player_turn(const bool color)
             // Ожидаем выбора клетки для продолжения хода
             auto resp = hand.get_cell();
             if (get<0>(resp) != Response::CELL)
+            {
+                logic.stop_search();
                 return get<0>(resp);
+            }
                 
             pair<POS_T, POS_T> cell{get<1>(resp), get<2>(resp)};
 
@@ -1,4 +1,5 @@
 #pragma once
+#include <functional>
 #include <tuple>
 
 #include "../Models/Move.h"
@@ -6,12 +7,30 @@
 #include "Board.h"
 
 // methods for hands
+// Ожидание событий блокирующее (SDL_WaitEvent), поэтому в простое окно не занимает процессор
 class Hand
 {
   public:
     Hand(Board *board) : board(board)
     {
     }
+
+    // Тип события SDL от потоков движка ("итерация поиска", "поиск закончен"), регистрируется один раз
+    static Uint32 engine_event()
+    {
+        static const Uint32 type = SDL_RegisterEvents(1);
+        return type;
+    }
+
+    // Будит ожидание событий из любого потока (SDL_PushEvent потокобезопасна); code - данные события
+    static void wake(const int code = 0)
+    {
+        SDL_Event event;
+        SDL_zero(event);
+        event.type = engine_event();
+        event.user.code = code;
+        SDL_PushEvent(&event);
+    }
     tuple<Response, POS_T, POS_T> get_cell() const
     {
         SDL_Event windowEvent;
@@ -20,7 +39,8 @@ class Hand
         int xc = -1, yc = -1;
         while (true)
         {
-            if (SDL_PollEvent(&windowEvent))
+            board->flush(); // Накопленные изменения доски - одним кадром перед ожиданием
+            if (SDL_WaitEvent(&windowEvent))
             {
                 switch (windowEvent.type)
                 {
@@ -32,7 +52,7 @@ class Hand
                     y = windowEvent.motion.y;
                     xc = int(y / (board->H / 10) - 1);
                     yc = int(x / (board->W / 10) - 1);
-                    if (xc == -1 && yc == -1 && board->history_mtx.size() > 1)
+                    if (xc == -1 && yc == -1 && board->history_size() > 0)
                     {
                         resp = Response::BACK;
                     }
@@ -51,11 +71,16 @@ class Hand
                     }
                     break;
                 case SDL_WINDOWEVENT:
-                    if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+                    if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED ||
+                        windowEvent.window.event == SDL_WINDOWEVENT_EXPOSED)
                     {
                         board->reset_window_size();
                         break;
                     }
+                    break;
+                case SDL_RENDER_TARGETS_RESET: // Содержимое текстур кадра потеряно
+                    board->reset_window_size();
+                    break;
                 }
                 if (resp != Response::OK)
                     break;
@@ -70,14 +95,20 @@ class Hand
         Response resp = Response::OK;
         while (true)
         {
-            if (SDL_PollEvent(&windowEvent))
+            board->flush(); // Накопленные изменения доски - одним кадром перед ожиданием
+            if (SDL_WaitEvent(&windowEvent))
             {
                 switch (windowEvent.type)
                 {
                 case SDL_QUIT:
                     resp = Response::QUIT;
                     break;
-                case SDL_WINDOWEVENT_SIZE_CHANGED:
+                case SDL_WINDOWEVENT:
+                    if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED ||
+                        windowEvent.window.event == SDL_WINDOWEVENT_EXPOSED)
+                        board->reset_window_size();
+                    break;
+                case SDL_RENDER_TARGETS_RESET:
                     board->reset_window_size();
                     break;
                 case SDL_MOUSEBUTTONDOWN: {
@@ -97,6 +128,61 @@ class Hand
         return resp;
     }
 
+    /**
+     * Обработка событий окна, пока идет работа в другом потоке (поиск бота): возвращает OK,
+     * когда ready() станет истинным, или QUIT/BACK/REPLAY, если игрок нажал их раньше.
+     * Поток движка будит ожидание через wake(), по таймауту проверяются условия по времени
+     * @param on_engine_event вызывается в главном потоке для каждого события wake(code)
+     */
+    Response wait_until(const function<bool()> &ready,
+                        const function<void(int)> &on_engine_event = function<void(int)>()) const
+    {
+        SDL_Event windowEvent;
+        Response resp = Response::OK;
+        while (true)
+        {
+            board->flush();
+            if (ready())
+                break;
+            if (!SDL_WaitEventTimeout(&windowEvent, 10))
+                continue;
+            if (windowEvent.type == engine_event())
+            {
+                if (on_engine_event)
+                    on_engine_event(windowEvent.user.code);
+                continue;
+            }
+            switch (windowEvent.type)
+            {
+            case SDL_QUIT:
+                resp = Response::QUIT;
+                break;
+            case SDL_MOUSEBUTTONDOWN: {
+                int x = windowEvent.motion.x;
+                int y = windowEvent.motion.y;
+                int xc = int(y / (board->H / 10) - 1);
+                int yc = int(x / (board->W / 10) - 1);
+                if (xc == -1 && yc == -1 && board->history_size() > 0)
+                    resp = Response::BACK;
+                else if (xc == -1 && yc == 8)
+                    resp = Response::REPLAY;
+            }
+            break;
+            case SDL_WINDOWEVENT:
+                if (windowEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED ||
+                    windowEvent.window.event == SDL_WINDOWEVENT_EXPOSED)
+                    board->reset_window_size();
+                break;
+            case SDL_RENDER_TARGETS_RESET:
+                board->reset_window_size();
+                break;
+            }
+            if (resp != Response::OK)
+                break;
+        }
+        return resp;
+    }
+
   private:
     Board *board;
 };
@@ -1,39 +1,263 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <numeric>
 #include <random>
+#include <thread>
 #include <vector>
 
 #include "../Models/Move.h"
-#include "Board.h"
 #include "Config.h"
+#include "OpeningBook.h"
+#include "Position.h"
+#include "Tablebase.h"
+#include "TransTable.h"
 
-const int INF = 1e9; // Бесконечность для алгоритма минимакс
+// Оценки - целые числа с точки зрения черных: материальная оценка лежит в пределах ±EVAL_SCALE,
+// выигрыш черных на уровне ply оценивается MATE - ply, выигрыш белых - -(MATE - ply),
+// поэтому из двух выигрышей предпочитается более быстрый, а из двух проигрышей - более долгий
+const int INF = 1e9;                 // Бесконечность для алгоритма минимакс (за пределами любых оценок)
+const int EVAL_SCALE = 10000;        // Оценка при материале только у черных (без выигрыша)
+const int MATE = 30000;              // Выигрыш черных в корне
+const int MATE_BOUND = MATE - 1000;  // Оценки не меньше по модулю - выигрыш с известным расстоянием
+const int DRAW_SCORE = 0;            // Оценка ничьей (повторение позиции, ничья по таблицам): равный материал
+
+// Качество сортировки ходов: доля отсечений по beta, случившихся на первом же ходе узла
+struct order_stats
+{
+    uint64_t cutoffs = 0;            // Узлов с отсечением
+    uint64_t first_move_cutoffs = 0; // Из них отсечений на первом ходе
+
+    double first_move_rate() const
+    {
+        return cutoffs ? double(first_move_cutoffs) / cutoffs : 0;
+    }
+
+    void add(const order_stats &other)
+    {
+        cutoffs += other.cutoffs;
+        first_move_cutoffs += other.first_move_cutoffs;
+    }
+};
+
+/**
+ * Итог одного поиска хода. Счетчики ведет каждый поток отдельно без синхронизации,
+ * Logic суммирует их один раз после поиска, поэтому сбор статистики включен всегда
+ */
+struct search_stats
+{
+    int depth = 0;          // Глубина последней завершенной итерации
+    int seldepth = 0;       // Наибольшее удаление узла от корня в ходах (с продлением взятий)
+    uint64_t nodes = 0;     // Узлы всех потоков
+    uint64_t qnodes = 0;    // Из них узлы продления взятий
+    tt_stats tt;            // Обращения к таблице транспозиций
+    order_stats order;      // Отсечения по beta
+    double ms = 0;          // Время поиска
+    int score = 0;          // Оценка лучшего хода с точки зрения черных
+    vector<bit_move> pv;    // Главный вариант: лучший ход и ожидаемые ответы (из таблицы транспозиций)
+    bool book = false;      // Ход взят из дебютной книги без поиска (в pv только он)
+    bool tablebase = false; // Ход взят из таблиц эндшпиля без поиска (в pv только он, score - итог партии)
+
+    double nps() const
+    {
+        return ms > 0 ? nodes * 1000.0 / ms : 0;
+    }
+
+    // Главный вариант в записи "22x13 9-14 ..."
+    string pv_string() const
+    {
+        string res;
+        for (const auto &turn : pv)
+            res += (res.empty() ? "" : " ") + move_notation(turn);
+        return res;
+    }
+
+    // Строка журнала поиска (одна строка JSON на ход)
+    json to_json() const
+    {
+        return {{"depth", depth},
+                {"seldepth", seldepth},
+                {"nodes", nodes},
+                {"qnodes", qnodes},
+                {"nps", uint64_t(nps())},
+                {"ms", ms},
+                {"tt_probes", tt.probes},
+                {"tt_hits", tt.hits},
+                {"cutoffs", order.cutoffs},
+                {"first_move_cutoff_rate", order.first_move_rate()},
+                {"score", score},
+                {"pv", pv_string()},
+                {"book", book},
+                {"tablebase", tablebase}};
+    }
+
+    // Краткая сводка для заголовка окна
+    string summary() const
+    {
+        if (book)
+            return "book move " + pv_string();
+        if (tablebase)
+            return "tablebase move " + pv_string() + (score > 0 ? ", black wins" : score < 0 ? ", white wins" : ", draw");
+        return "depth " + to_string(depth) + "/" + to_string(seldepth) + ", " + to_string(nodes) + " nodes, " +
+               to_string(int64_t(nps() / 1000)) + " kN/s, " + to_string(int64_t(ms)) + " ms, pv " + pv_string();
+    }
+};
 
 class Logic
 {
   public:
-    // Конструктор, инициализирующий логику игры с доской и конфигурацией
-    Logic(Board *board, Config *config) : board(board), config(config)
+    /**
+     * Логика игры с доской: перегрузки без позиции ищут ходы на текущей расстановке board->get_board().
+     * Тип доски - параметр шаблона, поэтому Logic.h не зависит от Board.h и SDL
+     * и собирается в консольные утилиты без окна
+     */
+    template <class BoardT> Logic(BoardT *board, Config *config) : Logic(config)
+    {
+        board_state = [board]() { return board->get_board(); };
+    }
+
+    // Логика без доски (консольные утилиты): позиция передается в каждый вызов
+    explicit Logic(Config *config) : config(config)
     {
         // Инициализация генератора случайных чисел (с случайным seed или фиксированным)
         rand_eng = std::default_random_engine (
             !((*config)("Bot", "NoRandom")) ? unsigned(time(0)) : 0);
+        // У поиска свой генератор: фоновый поиск не делит генератор с интерфейсом
+        search_rand_eng.seed(rand_eng());
         scoring_mode = (*config)("Bot", "BotScoringType"); // Режим оценки позиции
+        potential_scoring = scoring_mode == "NumberAndPotential";
         optimization = (*config)("Bot", "Optimization");   // Уровень оптимизации
+        time_budget_ms = (*config)("Bot", "TimeBudgetMS");  // Бюджет времени на ход (0 - без ограничения)
+        const int tt_size_mb = (*config)("Bot", "TTSizeMB"); // Размер таблицы транспозиций
+        tt.resize(tt_size_mb);
+        no_random = (*config)("Bot", "NoRandom");
+        // Приемы уровня "O2", каждый можно выключить отдельно
+        lmr_enabled = (*config)("Bot", "O2LateMoveReductions");
+        pvs_enabled = (*config)("Bot", "O2NullWindow");
+        futility_enabled = (*config)("Bot", "O2Futility");
+        aspiration_enabled = (*config)("Bot", "AspirationWindows"); // Окно вокруг оценки прошлой итерации
+        quiescence_depth = (*config)("Bot", "QuiescenceDepth"); // Предел продления взятий за горизонтом
+        search_log = (*config)("Bot", "SearchLog");             // Журнал поиска (пусто - не вести)
+        const string book_path = (*config)("Bot", "OpeningBook"); // Дебютная книга (нет файла - без книги)
+        if (!book_path.empty())
+            book.open(project_path + book_path);
+        const string tablebase_path = (*config)("Bot", "Tablebases"); // Таблицы эндшпиля (нет файлов - без них)
+        if (!tablebase_path.empty())
+            tablebase.open(project_path + tablebase_path);
+        set_threads((*config)("Bot", "Threads"));
     }
 
     // Публичные поля класса
     vector<move_pos> turns;  // Список возможных ходов для текущей позиции
     bool have_beats;         // Флаг наличия взятий среди возможных ходов
     int Max_depth;           // Максимальная глубина поиска для алгоритма минимакс
+    int reached_depth = 0;   // Глубина последней полностью завершенной итерации поиска
+    uint64_t nodes = 0;      // Число узлов, просмотренных последним поиском (всеми потоками)
+    uint64_t qnodes = 0;     // Из них узлов продления взятий за горизонтом
+    int researches = 0;      // Повторные поиски корня главным потоком после выхода оценки за окно
+    search_stats last_search; // Статистика последнего поиска
+    TransTable tt;           // Таблица транспозиций, общая для потоков (сохраняется между ходами)
+    bool runtime_dispatch = false; // Проверять режимы оценки и оптимизации в каждом узле (для сравнения в bench)
+    // Уведомление из потока поиска (например, чтобы разбудить интерфейс): depth > 0 - главный поток
+    // завершил итерацию этой глубины, 0 - фоновый поиск закончен. Вызывается в потоке поиска
+    function<void(int)> notify;
 
   private:
     // Приватные поля класса
     default_random_engine rand_eng;  // Генератор случайных чисел для перемешивания ходов
+    default_random_engine search_rand_eng; // Генератор поиска (порядок ходов корня, seed потоков)
     string scoring_mode;              // Режим оценки позиции ("NumberAndPotential" и др.)
+    bool potential_scoring;           // scoring_mode == "NumberAndPotential" (сравнение строк один раз)
     string optimization;              // Уровень оптимизации алгоритма ("O0", "O1" и т.д.)
-    vector<move_pos> next_move;       // Вектор лучших ходов для каждого состояния
-    vector<int> next_best_state;      // Вектор переходов между состояниями для построения цепочки ходов
-    Board *board;                     // Указатель на игровую доску
+    int time_budget_ms;               // Бюджет времени на ход в миллисекундах (0 - только глубина)
+    move_list bit_turns;              // Буфер ходов битовой доски для интерфейса
+    bool no_random;                   // Детерминированный режим (NoRandom)
+    bool lmr_enabled;                 // "O2": сокращение глубины для поздних тихих ходов
+    bool pvs_enabled;                 // "O2": поиск главного варианта с нулевым окном
+    bool futility_enabled;            // "O2": отсечение бесперспективных тихих ходов у листьев
+    bool aspiration_enabled;          // Окна вокруг оценки прошлой итерации в корне (O1, O2)
+    int quiescence_depth;             // Предел продления взятий за горизонтом в ходах (0 - без продления)
+    string search_log;                // Файл журнала поиска: строка JSON на каждый ход (SearchLog)
+    OpeningBook book;                 // Дебютная книга, отображенная в память (OpeningBook)
+    Tablebase tablebase;              // Таблицы эндшпиля из одних дамок, отображенные в память (Tablebases)
+
+    // Стек перебора: позиция изменяется на месте через do_move/undo_move,
+    // для каждого уровня заранее выделен свой буфер ходов, поэтому узел перебора не выделяет память
+    static const int MAX_PLY = 128;
+    // Окно корня: [prev - d, prev + d] для оценки прошлой итерации prev. При выходе оценки за границу
+    // d этой границы удваивается, начиная с ASPIRATION_WIDTH, а с ASPIRATION_MAX граница снимается
+    static const int ASPIRATION_WIDTH = 25;
+    static const int ASPIRATION_MAX = EVAL_SCALE / 2;
+    static const int MAN_VALUE = 20; // Шашка в единицах материала (бонус за строку продвижения - 1)
+    // Запас отсечения бесперспективных ходов: шашка и еще полшашки на позиционные колебания
+    static const int FUTILITY_MARGIN = MAN_VALUE * 3 / 2;
+
+    // Состояние одного потока поиска
+    struct search_thread
+    {
+        int id = 0;                                               // 0 - главный поток
+        Position pos;                                             // Текущая позиция перебора
+        vector<move_list> ply_moves = vector<move_list>(MAX_PLY); // Буферы ходов по уровням
+        vector<bit_move> root_turns;                              // Ходы корня
+        uint64_t nodes = 0;                                       // Просмотренные узлы
+        uint64_t qnodes = 0;                                      // Из них узлы продления взятий
+        int seldepth = 0;                                         // Наибольший достигнутый уровень
+        tt_stats tt_counters;                                     // Обращения потока к таблице
+        order_stats order_counters;                               // Отсечения по beta
+        default_random_engine rand_eng;                           // Порядок ходов корня у помощников
+        // Сортировка ходов: ключи ходов по уровням, ходы-убийцы и таблица истории
+        vector<array<int64_t, move_list::MAX_SIZE>> ply_keys =
+            vector<array<int64_t, move_list::MAX_SIZE>>(MAX_PLY);
+        bit_move killers[MAX_PLY][2];   // Два последних тихих хода, давших отсечение на уровне
+        uint32_t history[2][32][32];    // Успешность тихих ходов [цвет][откуда][куда]
+        // Стек хешей для повторений: позиции партии до корня (game_plies штук), затем позиции пути перебора
+        vector<uint64_t> key_stack = vector<uint64_t>(MAX_PLY + 256);
+        int game_plies = 0;
+        material_counts ply_material[MAX_PLY]; // Материал позиции на уровне
+        int reversible[MAX_PLY];               // Число обратимых ходов подряд, приведших к позиции уровня
+    };
+    vector<unique_ptr<search_thread>> threads; // threads[0] - главный поток
+
+    // Состояние итеративного углубления
+    chrono::steady_clock::time_point deadline;     // Момент, когда поиск должен остановиться
+    unique_ptr<atomic<bool>> stop = unique_ptr<atomic<bool>>(new atomic<bool>(false)); // Флаг остановки поиска
+    bool pruning = true;                           // Включено ли альфа-бета отсечение (не "O0")
+    bool o2_search = false;                        // Включены ли приемы "O2"
+    bool exact_tt = false;                         // Отсечения по таблице только с равной глубиной
+    int root_score = 0;                            // Оценка последней завершенной итерации главного потока
+    const atomic<bool> *cancel_token = nullptr;    // Флаг отмены текущего поиска (из другого потока)
+    const vector<uint64_t> *game_history = nullptr; // Позиции партии до корня текущего поиска (для повторений)
+    Position last_root;                            // Корень последнего поиска (для предсказания ответа)
+
+    // Поиск в фоновом потоке: ход бота и размышление в ход соперника
+    struct background_search
+    {
+        thread worker;
+        atomic<bool> cancel{false};    // Флаг отмены для find_best_turns
+        atomic<bool> done{true};       // Поиск закончен, результат в turns
+        atomic<bool> pondering{false}; // Поиск идет в ход соперника (до ponder_hit)
+        Position pos;                  // Позиция поиска
+        bool color = false;            // Цвет стороны, делающей ход в pos
+        vector<uint64_t> history;      // Позиции партии до pos (для повторений)
+        vector<move_pos> turns;        // Результат
+
+        ~background_search()
+        {
+            cancel = true;
+            if (worker.joinable())
+                worker.join();
+        }
+    };
+    unique_ptr<background_search> background = unique_ptr<background_search>(new background_search());
+    function<vector<vector<POS_T>>()> board_state; // Текущая расстановка игровой доски
     Config *config;                   // Указатель на конфигурацию игры
 
 public:
@@ -45,7 +269,7 @@ public:
      */
     void find_turns(const bool color)
     {
-        find_turns(color, board->get_board());
+        find_turns(color, Position(board_state()));
     }
 
     /**
@@ -55,244 +279,1152 @@ public:
      */
     void find_turns(const POS_T x, const POS_T y)
     {
-        find_turns(x, y, board->get_board());
+        find_turns(x, y, Position(board_state()));
     }
 
-private:
     /**
-     * Находит все возможные ходы для указанного цвета на произвольной доске
-     * Собирает ходы со всех фигур указанного цвета, приоритет отдает взятиям
-     * @param color цвет игрока
-     * @param mtx матрица состояния доски
+     * Ищет лучший ход для указанного цвета итеративным углублением с альфа-бета отсечением.
+     * Глубина растет от 1 до Max_depth + 1; при заданном TimeBudgetMS поиск останавливается
+     * по истечении бюджета и возвращает лучший ход последней завершенной итерации
+     * @param color цвет бота
+     * @return последовательность шагов лучшего хода (несколько шагов при серии взятий)
+     */
+    vector<move_pos> find_best_turns(const bool color)
+    {
+        return find_best_turns(Position(board_state()), color);
+    }
+
+    /**
+     * То же для произвольной позиции (без доски: консольные утилиты, поиск в фоновом потоке).
+     * Позиция из дебютной книги не ищется: ход берется из книги (с NoRandom - ход с наибольшим весом).
+     * Так же без поиска играется позиция из таблиц эндшпиля
+     * @param cancel флаг отмены, который выставляет другой поток; поиск проверяет его раз в 1024 узла
+     * и прерывается, результат прерванного поиска использовать нельзя
+     * @param history хеши позиций партии (Position::key) с последнего необратимого хода до start, без нее:
+     * повторение одной из них в переборе оценивается как ничья
      */
-    void find_turns(const bool color, const vector<vector<POS_T>> &mtx)
+    vector<move_pos> find_best_turns(const Position &start, const bool color, const atomic<bool> *cancel = nullptr,
+                                     const vector<uint64_t> &history = {})
     {
-        vector<move_pos> res_turns;
-        bool have_beats_before = false;
-        
-        // Проход по всем клеткам доски
-        for (POS_T i = 0; i < 8; ++i)
+        threads[0]->pos = start;
+        bit_move book_turn;
+        // Книга построена на одном уровне и играет только за ботов не слабее его
+        if (Max_depth >= book.level() && book.probe(start, color, no_random ? nullptr : &search_rand_eng, book_turn))
+            return play_known(color, book_turn, true, 0);
+        int tablebase_result;
+        if (tablebase_move(start, color, book_turn, tablebase_result))
+            return play_known(color, book_turn, false, tablebase_result);
+        cancel_token = cancel;
+        game_history = &history;
+        vector<move_pos> res = dispatch_search(color, Max_depth + 1);
+        cancel_token = nullptr;
+        game_history = nullptr;
+        return res;
+    }
+
+    // === ПОИСК В ФОНОВОМ ПОТОКЕ ===
+    // Пока идет фоновый поиск, остальные методы поиска вызывать нельзя (find_turns - можно)
+
+    // Запускает поиск хода для позиции pos в фоновом потоке (прежний фоновый поиск отменяется),
+    // history - как в find_best_turns
+    void start_search(const Position &pos, const bool color, const vector<uint64_t> &history = {})
+    {
+        run_background(pos, color, false, history);
+    }
+
+    /**
+     * Размышление в ход соперника: пока соперник (цвет color) думает над позицией pos, бот ищет
+     * свой ход в позиции после ожидаемого ответа - второго хода главного варианта прошлого поиска.
+     * До ponder_hit поиск не ограничен по времени. Таблица транспозиций остается заполненной
+     * и при другом ответе соперника
+     * @param history хеши позиций партии с последнего необратимого хода до pos (как в find_best_turns)
+     * @return false, если ответ предсказать нельзя (нет прошлого поиска или позиция не из него)
+     */
+    bool ponder(const Position &pos, const bool color, const vector<uint64_t> &history = {})
+    {
+        stop_search();
+        const vector<bit_move> &pv = last_search.pv;
+        if (pv.size() < 2)
+            return false;
+        Position next = last_root;
+        Position::undo_info undo;
+        next.do_move(pv[0], undo);
+        if (next.key(color) != pos.key(color))
+            return false;
+        move_list moves;
+        next.gen_moves(color, moves);
+        if (find(moves.begin(), moves.end(), pv[1]) == moves.end())
+            return false;
+        // История для позиции после ответа: pos добавляется, если ответ обратим, иначе история начинается заново
+        vector<uint64_t> next_history;
+        const material_counts before = next.material;
+        next.do_move(pv[1], undo);
+        if (next.material == before)
+        {
+            next_history = history;
+            next_history.push_back(pos.key(color));
+        }
+        run_background(next, !color, true, next_history);
+        return true;
+    }
+
+    /**
+     * Ход соперника сделан: если он совпал с предсказанным, размышление продолжается как обычный поиск
+     * (найденное не пропадает, бюджет времени отсчитан от начала размышления), иначе оно отменяется
+     * @return true, если фоновый поиск теперь ищет ход для позиции pos
+     */
+    bool ponder_hit(const Position &pos, const bool color)
+    {
+        if (background->pondering && background->color == color && background->pos.key(color) == pos.key(color))
+        {
+            background->pondering = false;
+            return true;
+        }
+        stop_search();
+        return false;
+    }
+
+    // Закончен ли фоновый поиск
+    bool search_done() const
+    {
+        return background->done;
+    }
+
+    // Дожидается фонового поиска и возвращает найденный ход (шаги серии взятий)
+    vector<move_pos> search_result()
+    {
+        if (background->worker.joinable())
+            background->worker.join();
+        return background->turns;
+    }
+
+    // Отменяет фоновый поиск (в пределах миллисекунд) и дожидается его потока
+    void stop_search()
+    {
+        background->cancel = true;
+        if (background->worker.joinable())
+            background->worker.join();
+        background->pondering = false;
+    }
+
+    /**
+     * Задает число потоков поиска (Threads в settings.json).
+     * Без NoRandom потоки-помощники ищут ту же позицию по схеме Lazy SMP, обмениваясь
+     * результатами через общую таблицу транспозиций. С NoRandom ходы корня делятся между
+     * потоками и каждый оценивается точно, поэтому в режиме "O1" выбранный ход воспроизводим
+     * от запуска к запуску (см. split_root)
+     */
+    void set_threads(const int count)
+    {
+        threads.resize(max(1, count));
+        for (size_t i = 0; i < threads.size(); ++i)
         {
-            for (POS_T j = 0; j < 8; ++j)
+            if (!threads[i])
             {
-                // Проверка, что фигура принадлежит нужному игроку
-                if (mtx[i][j] && mtx[i][j] % 2 != color)
-                {
-                    // Находим ходы для конкретной фигуры
-                    find_turns(i, j, mtx);
-                    
-                    // Если нашли взятия и до этого их не было - очищаем результат
-                    if (have_beats && !have_beats_before)
-                    {
-                        have_beats_before = true;
-                        res_turns.clear();
-                    }
-                    
-                    // Добавляем ходы если: есть взятия и мы их уже собираем ИЛИ нет взятий
-                    if ((have_beats_before && have_beats) || !have_beats_before)
-                    {
-                        res_turns.insert(res_turns.end(), turns.begin(), turns.end());
-                    }
-                }
+                threads[i].reset(new search_thread());
+                memset(threads[i]->history, 0, sizeof(threads[i]->history));
             }
+            threads[i]->id = int(i);
+            threads[i]->rand_eng.seed(unsigned(i));
         }
-        turns = res_turns;
+    }
+
+    // Сброс накопленного между ходами знания (таблица транспозиций, история ходов) перед новой партией
+    void new_game()
+    {
+        tt.clear();
+        for (auto &th : threads)
+            memset(th->history, 0, sizeof(th->history));
+    }
+
+    // Оценка позиции с точки зрения черных (та же, что в листьях перебора)
+    int evaluate(const Position &pos) const
+    {
+        return calc_score<scoring_runtime>(pos, true);
+    }
+
+    // Статистика отсечений за последний поиск (по всем потокам)
+    order_stats ordering_stats() const
+    {
+        order_stats res;
+        for (const auto &th : threads)
+            res.add(th->order_counters);
+        return res;
+    }
+
+    // Статистика таблицы транспозиций за последний поиск (по всем потокам)
+    tt_stats table_stats() const
+    {
+        tt_stats res;
+        for (const auto &th : threads)
+            res.add(th->tt_counters);
+        res.entries = tt.entries();
+        res.fill_permille = tt.fill_permille();
+        return res;
+    }
+
+    /**
+     * Считает число листьев дерева ходов глубины depth из позиции start (серия взятий - один ход,
+     * совпадающие по результату пути серии считаются одним ходом).
+     * Использует тот же стек перебора, что и бот: do_move/undo_move и буферы ходов по уровням
+     * @param start начальная позиция
+     * @param color цвет стороны, делающей ход
+     * @param depth глубина в ходах
+     */
+    uint64_t perft(const Position &start, const bool color, const int depth)
+    {
+        threads[0]->pos = start;
+        return ::perft(threads[0]->pos, color, depth, threads[0]->ply_moves.data());
+    }
+
+private:
+    /**
+     * Находит все возможные ходы для указанного цвета на произвольной позиции
+     * Если хотя бы одна фигура может бить - возвращаются только взятия
+     * @param color цвет игрока
+     * @param pos битовое представление доски
+     */
+    void find_turns(const bool color, const Position &pos)
+    {
+        have_beats = pos.gen_steps(color, bit_turns);
+        set_turns(bit_turns);
         // Перемешиваем ходы для разнообразия игры бота
         shuffle(turns.begin(), turns.end(), rand_eng);
-        have_beats = have_beats_before;
     }
 
     /**
-     * Находит все возможные ходы для конкретной фигуры на произвольной доске
+     * Находит все возможные ходы для фигуры на клетке (x, y) произвольной позиции
      * Сначала проверяет взятия, затем обычные ходы
-     * @param x координата X фигуры
-     * @param y координата Y фигуры  
-     * @param mtx матрица состояния доски
      */
-    void find_turns(const POS_T x, const POS_T y, const vector<vector<POS_T>> &mtx)
+    void find_turns(const POS_T x, const POS_T y, const Position &pos)
+    {
+        have_beats = pos.gen_piece_moves(to_square(x, y), bit_turns);
+        set_turns(bit_turns);
+    }
+
+    // Перевод ходов битовой доски в координаты матрицы для интерфейса
+    void set_turns(const move_list &moves)
     {
         turns.clear();
-        have_beats = false;
-        POS_T type = mtx[x][y];
-        
-        // Проверка ВЗЯТИЙ (приоритет)
-        switch (type)
-        {
-        case 1: // Белая шашка
-        case 2: // Черная шашка
-            // Проверка взятий для обычных шашек (ход на 2 клетки по диагонали)
-            for (POS_T i = x - 2; i <= x + 2; i += 4)
+        for (const auto &turn : moves)
+        {
+            if (turn.beaten)
             {
-                for (POS_T j = y - 2; j <= y + 2; j += 2)
-                {
-                    if (i < 0 || i > 7 || j < 0 || j > 7)
-                        continue;
-                    POS_T xb = (x + i) / 2, yb = (y + j) / 2; // Координаты побитой фигуры
-                    
-                    // Условия корректного взятия:
-                    // - Конечная клетка свободна
-                    // - Между начальной и конечной есть фигура противника
-                    // - Эта фигура принадлежит противнику
-                    if (mtx[i][j] || !mtx[xb][yb] || mtx[xb][yb] % 2 == type % 2)
-                        continue;
-                    turns.emplace_back(x, y, i, j, xb, yb);
-                }
+                const int b = bit_first(turn.beaten);
+                turns.emplace_back(square_x(turn.from), square_y(turn.from), square_x(turn.to), square_y(turn.to),
+                                   square_x(b), square_y(b));
             }
-            break;
-        default: // Дамки (3 - белая, 4 - черная)
-            // Проверка взятий для дамок (ход на любое расстояние по диагонали)
-            for (POS_T i = -1; i <= 1; i += 2)  // Направления по X
+            else
             {
-                for (POS_T j = -1; j <= 1; j += 2)  // Направления по Y
-                {
-                    POS_T xb = -1, yb = -1; // Координаты побитой фигуры
-                    
-                    // Движение по диагонали пока не выйдем за пределы доски
-                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j)
-                    {
-                        if (mtx[i2][j2]) // Если нашли фигуру
-                        {
-                            // Если это своя фигура ИЛИ уже нашли фигуру противника - прерываем
-                            if (mtx[i2][j2] % 2 == type % 2 || (mtx[i2][j2] % 2 != type % 2 && xb != -1))
-                            {
-                                break;
-                            }
-                            // Запоминаем координаты фигуры противника
-                            xb = i2;
-                            yb = j2;
-                        }
-                        // Если нашли фигуру противника и можем перепрыгнуть
-                        if (xb != -1 && xb != i2)
-                        {
-                            turns.emplace_back(x, y, i2, j2, xb, yb);
-                        }
-                    }
-                }
+                turns.emplace_back(square_x(turn.from), square_y(turn.from), square_x(turn.to), square_y(turn.to));
             }
-            break;
         }
-        
-        // Если нашли взятия - возвращаем только их
-        if (!turns.empty())
+    }
+
+    /**
+     * Взвешенный материал каждого цвета в единицах MAN_VALUE на шашку: шашки (с бонусом за продвижение
+     * в режиме "NumberAndPotential") плюс дамки с коэффициентом ценности.
+     * Счетчики поддерживаются позицией в do_move/undo_move, поэтому оценка не просматривает доску
+     * @param pos состояние доски
+     * @param w материал белых
+     * @param b материал черных
+     */
+    template <class Scoring> void calc_material(const Position &pos, int &w, int &b) const
+    {
+        const material_counts &m = pos.material;
+        w = m.men[0] * MAN_VALUE;
+        b = m.men[1] * MAN_VALUE;
+
+        // Дополнительная оценка потенциала для обычных шашек:
+        // бонус 1/20 шашки за каждую строку, пройденную к дамочному полю
+        if (Scoring::potential(*this))
         {
-            have_beats = true;
-            return;
+            w += m.steps[0];
+            b += m.steps[1];
         }
-        
-        // Проверка ОБЫЧНЫХ ХОДОВ (если нет взятий)
-        switch (type)
+
+        // Коэффициент ценности дамки относительно шашки (в режиме с потенциалом дамки ценятся выше)
+        const int q_coef = Scoring::potential(*this) ? 5 : 4;
+        w += m.kings[0] * q_coef * MAN_VALUE;
+        b += m.kings[1] * q_coef * MAN_VALUE;
+    }
+
+    /**
+     * Оценка материала b бота против материала w противника: EVAL_SCALE * (b - w) / (b + w).
+     * Растет вместе с отношением b / w, поэтому позиции упорядочены так же, как отношением материала,
+     * но считается в целых числах. Без фигур у одной из сторон - выигрыш (MATE) или проигрыш (-MATE)
+     */
+    static int material_score(const int w, const int b)
+    {
+        if (w == 0) // Противник проиграл
+            return MATE;
+        if (b == 0) // Бот проиграл
+            return -MATE;
+        return EVAL_SCALE * (b - w) / (b + w);
+    }
+
+    /**
+     * Вычисляет оценку текущей позиции для алгоритма минимакс
+     * @param pos состояние доски для оценки
+     * @param first_bot_color цвет бота, для которого считается оценка
+     * @return числовая оценка позиции (чем больше - тем лучше для бота)
+     */
+    template <class Scoring> int calc_score(const Position &pos, const bool first_bot_color) const
+    {
+        // color - who is max player
+        int w, b;
+        calc_material<Scoring>(pos, w, b);
+
+        // Если бот играет белыми - меняем местами оценки
+        if (!first_bot_color)
+            swap(b, w);
+
+        // Формула оценки: перевес фигур бота над фигурами противника (см. material_score)
+        return material_score(w, b);
+    }
+
+    /**
+     * Граница оценки (с точки зрения черных) после тихого хода шашкой без превращения стороны color
+     * на глубине 1, после которого у соперника нет взятий, но есть ходы: лист оценивается сразу, и материал стороны
+     * вырастает лишь на бонус за строку. Граница берется с запасом FUTILITY_MARGIN.
+     * Используется для отсечения в режиме "O2"
+     */
+    template <class Scoring> int futility_bound(const Position &pos, const bool color) const
+    {
+        int w, b;
+        calc_material<Scoring>(pos, w, b);
+        (color ? b : w) += FUTILITY_MARGIN;
+        return material_score(w, b);
+    }
+
+    // === ПОЛИТИКИ ПОИСКА ===
+    // Режимы BotScoringType и Optimization выбираются один раз перед поиском: перебор и оценка
+    // инстанцируются для каждой комбинации политик, и проверки режима в узлах становятся константами.
+    // Политики *_runtime читают режим из полей Logic в каждом узле (прежний путь, для сравнения в bench)
+
+    struct scoring_number_only // "NumberOnly"
+    {
+        static constexpr bool potential(const Logic &)
+        {
+            return false;
+        }
+    };
+    struct scoring_potential // "NumberAndPotential"
+    {
+        static constexpr bool potential(const Logic &)
+        {
+            return true;
+        }
+    };
+    struct scoring_runtime
+    {
+        static bool potential(const Logic &logic)
+        {
+            return logic.potential_scoring;
+        }
+    };
+
+    // alpha_beta - альфа-бета отсечение и таблица транспозиций, o2 - приемы "O2" (каждый со своим флагом)
+    template <bool AlphaBeta, bool O2> struct pruning_policy
+    {
+        static constexpr bool alpha_beta(const Logic &)
+        {
+            return AlphaBeta;
+        }
+        static constexpr bool o2(const Logic &)
+        {
+            return O2;
+        }
+    };
+    typedef pruning_policy<false, false> pruning_o0;
+    typedef pruning_policy<true, false> pruning_o1;
+    typedef pruning_policy<true, true> pruning_o2;
+    struct pruning_runtime
+    {
+        static bool alpha_beta(const Logic &logic)
+        {
+            return logic.pruning;
+        }
+        static bool o2(const Logic &logic)
+        {
+            return logic.o2_search;
+        }
+    };
+
+    // Выбор инстанцирования перебора по настройкам
+    vector<move_pos> dispatch_search(const bool color, const int max_depth)
+    {
+        pruning = optimization != "O0";
+        o2_search = optimization == "O2";
+        if (runtime_dispatch)
+            return iterative_deepening<scoring_runtime, pruning_runtime>(color, max_depth);
+        if (potential_scoring)
+            return dispatch_pruning<scoring_potential>(color, max_depth);
+        return dispatch_pruning<scoring_number_only>(color, max_depth);
+    }
+
+    template <class Scoring> vector<move_pos> dispatch_pruning(const bool color, const int max_depth)
+    {
+        if (o2_search)
+            return iterative_deepening<Scoring, pruning_o2>(color, max_depth);
+        if (pruning)
+            return iterative_deepening<Scoring, pruning_o1>(color, max_depth);
+        return iterative_deepening<Scoring, pruning_o0>(color, max_depth);
+    }
+
+    // === ПОИСК ЛУЧШЕГО ХОДА ===
+    // Оценки всегда считаются с точки зрения черных (calc_score(pos, true)):
+    // черные максимизируют оценку, белые минимизируют
+
+    // Итеративное углубление от корня с позицией threads[0]->pos до глубины max_depth
+    template <class Scoring, class Pruning>
+    vector<move_pos> iterative_deepening(const bool color, const int max_depth)
+    {
+        search_thread &main = *threads[0];
+        exact_tt = no_random && threads.size() > 1;
+        const auto search_start = chrono::steady_clock::now();
+        reached_depth = 0;
+        root_score = 0;
+        stop->store(false);
+        tt.new_search();
+        for (auto &th : threads)
         {
-        case 1: // Белая шашка (ходит только вперед - уменьшение X)
-        case 2: // Черная шашка (ходит только назад - увеличение X)
+            th->nodes = 0;
+            th->qnodes = 0;
+            th->seldepth = 0;
+            th->tt_counters = tt_stats();
+            th->order_counters = order_stats();
+            // Случайность в сортировке только при NoRandom = false
+            if (!no_random)
+                th->rand_eng.seed(search_rand_eng());
+            // Убийцы относятся к позиции, история сохраняется между ходами с затуханием
+            fill(&th->killers[0][0], &th->killers[0][0] + MAX_PLY * 2, bit_move());
+            for (auto &from : th->history)
+                for (auto &to : from)
+                    for (auto &value : to)
+                        value /= 4;
+            // Стек хешей начинается с позиций партии и корня
+            th->game_plies = game_history ? int(game_history->size()) : 0;
+            if (th->key_stack.size() < size_t(th->game_plies + MAX_PLY))
+                th->key_stack.resize(th->game_plies + MAX_PLY);
+            if (game_history)
+                copy(game_history->begin(), game_history->end(), th->key_stack.begin());
+            th->key_stack[th->game_plies] = main.pos.key(color);
+            th->ply_material[0] = main.pos.material;
+            th->reversible[0] = th->game_plies;
+        }
+        deadline = search_start + chrono::milliseconds(time_budget_ms);
+
+        move_list &moves = main.ply_moves[0];
+        main.pos.gen_moves(color, moves);
+        main.root_turns.assign(moves.begin(), moves.end());
+        if (main.root_turns.empty())
+        {
+            last_search = search_stats();
+            return {};
+        }
+        // Перемешиваем ходы для разнообразия игры бота (равные по оценке ходы выбираются случайно),
+        // затем первыми ставим взятия большего числа фигур
+        if (!no_random)
+            shuffle(main.root_turns.begin(), main.root_turns.end(), search_rand_eng);
+        stable_sort(main.root_turns.begin(), main.root_turns.end(), [](const bit_move &a, const bit_move &b) {
+            return bit_count(a.beaten) > bit_count(b.beaten);
+        });
+
+        if (threads.size() == 1 || exact_tt)
+        {
+            iterate<Scoring, Pruning>(main, color, max_depth);
+        }
+        else
+        {
+            // Lazy SMP: помощники перебирают ту же позицию со сдвигом глубины и своим порядком ходов
+            vector<thread> helpers;
+            for (size_t i = 1; i < threads.size(); ++i)
             {
-                POS_T i = ((type % 2) ? x - 1 : x + 1); // Направление движения
-                for (POS_T j = y - 1; j <= y + 1; j += 2) // Диагональные направления
-                {
-                    if (i < 0 || i > 7 || j < 0 || j > 7 || mtx[i][j])
-                        continue;
-                    turns.emplace_back(x, y, i, j);
-                }
+                search_thread &th = *threads[i];
+                th.pos = main.pos;
+                th.root_turns = main.root_turns;
+                shuffle(th.root_turns.begin(), th.root_turns.end(), th.rand_eng);
+                helpers.emplace_back([this, &th, color, max_depth]() { iterate<Scoring, Pruning>(th, color, max_depth); });
+            }
+            iterate<Scoring, Pruning>(main, color, max_depth);
+            stop->store(true);
+            for (auto &helper : helpers)
+                helper.join();
+        }
+        nodes = qnodes = 0;
+        for (const auto &th : threads)
+        {
+            nodes += th->nodes;
+            qnodes += th->qnodes;
+        }
+        collect_stats(color, chrono::duration<double, milli>(chrono::steady_clock::now() - search_start).count());
+
+        return turn_steps(main.pos, main.root_turns[0]);
+    }
+
+    // Серия взятий отдается интерфейсу по одному прыжку
+    static vector<move_pos> turn_steps(const Position &pos, const bit_move &turn)
+    {
+        vector<move_pos> res;
+        for (const auto &step : pos.chain_steps(turn))
+        {
+            const int b = step.beaten ? bit_first(step.beaten) : -1;
+            res.emplace_back(square_x(step.from), square_y(step.from), square_x(step.to), square_y(step.to),
+                             b == -1 ? -1 : square_x(b), b == -1 ? -1 : square_y(b));
+        }
+        return res;
+    }
+
+    // Ход из дебютной книги (from_book) или таблиц эндшпиля для корня threads[0]->pos: статистика без поиска
+    vector<move_pos> play_known(const bool color, const bit_move &turn, const bool from_book, const int score)
+    {
+        reached_depth = 0;
+        nodes = qnodes = 0;
+        last_root = threads[0]->pos;
+        last_search = search_stats();
+        last_search.book = from_book;
+        last_search.tablebase = !from_book;
+        last_search.score = score;
+        last_search.pv.push_back(turn);
+        write_search_log(color);
+        return turn_steps(threads[0]->pos, turn);
+    }
+
+    /**
+     * Ход по таблицам эндшпиля: при выигрыше - ведущий к самому быстрому выигрышу, при проигрыше -
+     * к самому долгому, при ничьей - сохраняющий ничью
+     * @param score итог партии с точки зрения черных (выигрыш с расстоянием до конца или DRAW_SCORE)
+     * @return false, если позиции или какой-нибудь позиции после хода нет в таблицах
+     */
+    bool tablebase_move(const Position &start, const bool color, bit_move &best, int &score) const
+    {
+        uint8_t value;
+        if (!tablebase.probe(start, color, value))
+            return false;
+        Position pos = start;
+        move_list moves;
+        pos.gen_moves(color, moves);
+        if (moves.empty())
+            return false;
+        Position::undo_info undo;
+        int best_rank = 0;
+        for (int i = 0; i < moves.size; ++i)
+        {
+            pos.do_move(moves[i], undo);
+            uint8_t child;
+            const bool known = tablebase.probe(pos, !color, child);
+            pos.undo_move(moves[i], undo);
+            if (!known)
+                return false;
+            // Проигрыш соперника - чем быстрее, тем лучше, его выигрыш - чем дольше, тем лучше
+            const int rank = tb_loss(child) ? 1000 - tb_plies(child) : tb_win(child) ? -1000 + tb_plies(child) : 0;
+            if (!i || rank > best_rank)
+            {
+                best_rank = rank;
+                best = moves[i];
+            }
+        }
+        score = tablebase_score(color, value, 0);
+        return true;
+    }
+
+    // Оценка позиции уровня ply из таблиц с точки зрения черных: выигрыш - на уровне конца партии,
+    // как у позиции без ходов у проигравшего
+    static int tablebase_score(const bool color, const uint8_t value, const int ply)
+    {
+        if (!value)
+            return DRAW_SCORE;
+        const int end = ply + tb_plies(value);
+        return tb_win(value) == color ? MATE - end : -(MATE - end);
+    }
+
+    // Оценка стороны color, у которой нет ходов на уровне ply: проигрыш, тем лучший для нее, чем он дальше
+    static int loss_score(const bool color, const int ply)
+    {
+        return color ? -(MATE - ply) : MATE - ply;
+    }
+
+    // Оценки выигрыша хранятся в таблице транспозиций от узла, а не от корня,
+    // так как позиция встречается на разных уровнях перебора
+    static int score_to_tt(const int score, const int ply)
+    {
+        return score >= MATE_BOUND ? score + ply : score <= -MATE_BOUND ? score - ply : score;
+    }
+
+    static int score_from_tt(const int score, const int ply)
+    {
+        return score >= MATE_BOUND ? score - ply : score <= -MATE_BOUND ? score + ply : score;
+    }
+
+    /**
+     * Цикл углубления одного потока. Лучший ход каждой итерации переносится в начало th.root_turns.
+     * Результат берется только из главного потока, помощники лишь наполняют таблицу транспозиций
+     */
+    template <class Scoring, class Pruning>
+    void iterate(search_thread &th, const bool color, const int max_depth)
+    {
+        // Окна вокруг прошлой оценки - только с альфа-бета отсечением и без разделения корня
+        const bool aspiration = Pruning::alpha_beta(*this) && aspiration_enabled && !exact_tt;
+        int prev_score = 0;
+        bool have_prev = false;
+        if (th.id == 0)
+            researches = 0;
+        // Помощники с нечетным номером начинают на ход глубже, чтобы потоки расходились по глубинам
+        for (int depth = 1 + (th.id & 1); depth <= max_depth; ++depth)
+        {
+            size_t best = 0;
+            int score;
+            if (exact_tt)
+                score = split_root<Scoring, Pruning>(color, depth, best);
+            else if (aspiration && have_prev)
+                score = aspiration_root<Scoring, Pruning>(th, color, depth, best, prev_score);
+            else
+                score = search_root<Scoring, Pruning>(th, th.root_turns, color, depth, best, -INF, INF);
+            if (stop->load(memory_order_relaxed))
+                break;
+            // Лучший ход итерации просматривается первым на следующей
+            rotate(th.root_turns.begin(), th.root_turns.begin() + best, th.root_turns.begin() + best + 1);
+            prev_score = score;
+            have_prev = true;
+            if (th.id == 0)
+            {
+                reached_depth = depth;
+                root_score = score;
+                if (notify)
+                    notify(depth);
+            }
+            // Выигрыш или проигрыш уже форсирован - углубляться незачем
+            if (abs(score) >= MATE_BOUND)
                 break;
+        }
+    }
+
+    // Оценка хода корня: ход выполняется на позиции потока, дальше обычный перебор
+    template <class Scoring, class Pruning>
+    int search_root_turn(search_thread &th, const bit_move &turn, const bool color, const int depth, const int alpha,
+                         const int beta)
+    {
+        Position::undo_info undo;
+        th.pos.do_move(turn, undo);
+        const int score = search<Scoring, Pruning>(th, !color, depth - 1, 1, alpha, beta);
+        th.pos.undo_move(turn, undo);
+        return score;
+    }
+
+    /**
+     * Одна итерация поиска из корня на глубину depth в окне (alpha, beta) по ходам turns в их порядке.
+     * В "O2" с O2NullWindow ходы после первого сначала проверяются нулевым окном, как во внутренних узлах
+     * @param best индекс лучшего хода в turns
+     * @return оценка лучшего хода; при выходе за окно - граница оценки (не лучше alpha или не хуже beta)
+     */
+    template <class Scoring, class Pruning>
+    int search_root(search_thread &th, const vector<bit_move> &turns, const bool color, const int depth, size_t &best,
+                    int alpha, int beta)
+    {
+        const bool use_pvs = Pruning::o2(*this) && pvs_enabled;
+        int best_score = color ? -INF : INF;
+        for (size_t i = 0; i < turns.size(); ++i)
+        {
+            int score;
+            bool full_window = true;
+            if (i > 0 && use_pvs)
+            {
+                const int lo = color ? alpha : beta - 1;
+                const int hi = color ? alpha + 1 : beta;
+                score = search_root_turn<Scoring, Pruning>(th, turns[i], color, depth, lo, hi);
+                // Полное окно нужно, только если ход попал внутрь окна
+                full_window = score > alpha && score < beta;
             }
-        default: // Дамки
-            // Дамка может ходить на любое количество клеток по диагонали
-            for (POS_T i = -1; i <= 1; i += 2)
+            if (full_window)
+                score = search_root_turn<Scoring, Pruning>(th, turns[i], color, depth, alpha, beta);
+            if (stop->load(memory_order_relaxed))
+                return 0;
+            if (color ? score > best_score : score < best_score)
             {
-                for (POS_T j = -1; j <= 1; j += 2)
-                {
-                    // Движение по диагонали пока не встретим препятствие
-                    for (POS_T i2 = x + i, j2 = y + j; i2 != 8 && j2 != 8 && i2 != -1 && j2 != -1; i2 += i, j2 += j)
-                    {
-                        if (mtx[i2][j2])
-                            break;
-                        turns.emplace_back(x, y, i2, j2);
-                    }
-                }
+                best_score = score;
+                best = i;
             }
-            break;
+            if (color)
+                alpha = max(alpha, best_score);
+            else
+                beta = min(beta, best_score);
+            // Отсечение в корне возможно только при суженном окне (aspiration_root)
+            if (alpha >= beta)
+                break;
         }
+        return best_score;
     }
 
     /**
-     * Выполняет ход на переданной матрице и возвращает новое состояние
-     * @param mtx исходное состояние доски
-     * @param turn ход для выполнения
-     * @return новое состояние доски после хода
+     * Итерация в окне вокруг оценки prev прошлой итерации (aspiration windows, см. ASPIRATION_WIDTH).
+     * Оценка внутри окна точная, а при выходе за окно поиск повторяется с расширенной границей,
+     * так что результат тот же, что у поиска с полным окном, но узкое окно отсекает больше.
+     * Повторы идут по своей копии порядка ходов: th.root_turns меняется только в iterate после завершения
+     * итерации, чтобы прерванный повтор не подменил лучший ход прошлой итерации
+     * @param best индекс лучшего хода в th.root_turns
      */
-    vector<vector<POS_T>> make_turn(vector<vector<POS_T>> mtx, move_pos turn) const
-    {
-        // Если ход включает взятие - удаляем побитую фигуру
-        if (turn.xb != -1)
-            mtx[turn.xb][turn.yb] = 0;
-            
-        // Проверка превращения в дамку
-        if ((mtx[turn.x][turn.y] == 1 && turn.x2 == 0) || (mtx[turn.x][turn.y] == 2 && turn.x2 == 7))
-            mtx[turn.x][turn.y] += 2;
-            
-        // Перемещение фигуры
-        mtx[turn.x2][turn.y2] = mtx[turn.x][turn.y];
-        mtx[turn.x][turn.y] = 0;
-        return mtx;
+    template <class Scoring, class Pruning>
+    int aspiration_root(search_thread &th, const bool color, const int depth, size_t &best, const int prev)
+    {
+        int low = ASPIRATION_WIDTH, high = ASPIRATION_WIDTH;
+        vector<bit_move> turns = th.root_turns;
+        vector<size_t> index(turns.size()); // Индексы ходов turns в th.root_turns
+        iota(index.begin(), index.end(), 0);
+        while (true)
+        {
+            const int alpha = low < ASPIRATION_MAX ? prev - low : -INF;
+            const int beta = high < ASPIRATION_MAX ? prev + high : INF;
+            best = 0;
+            const int score = search_root<Scoring, Pruning>(th, turns, color, depth, best, alpha, beta);
+            if (stop->load(memory_order_relaxed))
+                return 0;
+            if (score > alpha && score < beta)
+            {
+                best = index[best];
+                return score;
+            }
+            if (th.id == 0)
+                ++researches;
+            if (score <= alpha)
+                low *= 2;
+            else
+                high *= 2;
+            // Ход, вышедший за окно в пользу стороны, делающей ход, просматривается первым при повторе
+            if (color ? score >= beta : score <= alpha)
+            {
+                rotate(turns.begin(), turns.begin() + best, turns.begin() + best + 1);
+                rotate(index.begin(), index.begin() + best, index.begin() + best + 1);
+            }
+        }
     }
 
     /**
-     * Вычисляет оценку текущей позиции для алгоритма минимакс
-     * @param mtx состояние доски для оценки
-     * @param first_bot_color цвет бота, для которого считается оценка
-     * @return числовая оценка позиции (чем больше - тем лучше для бота)
+     * Итерация с разделением ходов корня между потоками (режим NoRandom).
+     * Каждый ход корня оценивается с полным окном, а таблица дает отсечения только
+     * для записей той же глубины, поэтому в режиме "O1" оценки точные и не зависят от порядка работы
+     * потоков; при равных оценках выбирается первый ход в порядке корня. В режиме "O2" сокращения
+     * и отсечения зависят от окна, под которым другой поток сохранил запись той же глубины, а ничьи
+     * повторением зависят от пути к позиции, поэтому там (и в эндшпиле дамок с повторениями) ход
+     * может зависеть от порядка работы потоков
      */
-    double calc_score(const vector<vector<POS_T>> &mtx, const bool first_bot_color) const
+    template <class Scoring, class Pruning>
+    int split_root(const bool color, const int depth, size_t &best)
     {
-        // color - who is max player
-        double w = 0, wq = 0, b = 0, bq = 0;
-        
-        // Подсчет количества фигур каждого типа
-        for (POS_T i = 0; i < 8; ++i)
+        const auto &root_turns = threads[0]->root_turns;
+        vector<int> scores(root_turns.size());
+        atomic<size_t> next(0);
+        auto worker = [&](search_thread &th) {
+            for (size_t i; (i = next++) < root_turns.size();)
+            {
+                scores[i] = search_root_turn<Scoring, Pruning>(th, root_turns[i], color, depth, -INF, INF);
+                if (stop->load(memory_order_relaxed))
+                    return;
+            }
+        };
+        vector<thread> helpers;
+        for (size_t i = 1; i < threads.size(); ++i)
         {
-            for (POS_T j = 0; j < 8; ++j)
+            threads[i]->pos = threads[0]->pos;
+            helpers.emplace_back(worker, ref(*threads[i]));
+        }
+        worker(*threads[0]);
+        for (auto &helper : helpers)
+            helper.join();
+
+        int best_score = scores[0];
+        for (size_t i = 1; i < scores.size(); ++i)
+        {
+            if (color ? scores[i] > best_score : scores[i] < best_score)
             {
-                w += (mtx[i][j] == 1);  // Белые шашки
-                wq += (mtx[i][j] == 3); // Белые дамки
-                b += (mtx[i][j] == 2);  // Черные шашки  
-                bq += (mtx[i][j] == 4); // Черные дамки
-                
-                // Дополнительная оценка потенциала для обычных шашек
-                if (scoring_mode == "NumberAndPotential")
+                best_score = scores[i];
+                best = i;
+            }
+        }
+        return best_score;
+    }
+
+    // === СТАТИСТИКА ПОИСКА ===
+
+    // Сводит счетчики потоков в last_search и пишет строку журнала (кроме отмененного поиска)
+    void collect_stats(const bool color, const double ms)
+    {
+        last_root = threads[0]->pos;
+        search_stats &st = last_search;
+        st = search_stats();
+        st.depth = reached_depth;
+        st.nodes = nodes;
+        st.qnodes = qnodes;
+        for (const auto &th : threads)
+            st.seldepth = max(st.seldepth, th->seldepth);
+        st.tt = table_stats();
+        st.order = ordering_stats();
+        st.ms = ms;
+        st.score = root_score;
+        st.pv = principal_variation(color);
+        if (!(cancel_token && cancel_token->load()))
+            write_search_log(color);
+    }
+
+    // Строка журнала поиска для last_search (если SearchLog задан)
+    void write_search_log(const bool color) const
+    {
+        if (search_log.empty())
+            return;
+        json line = last_search.to_json();
+        line["color"] = color ? "black" : "white";
+        line["position"] = last_root.to_fen(color);
+        line["move"] = last_search.pv.empty() ? "" : move_notation(last_search.pv[0]);
+        ofstream fout(search_log, ios_base::app);
+        fout << line.dump() << endl;
+    }
+
+    /**
+     * Главный вариант: лучший ход корня, затем лучшие ходы из таблицы транспозиций, пока запись
+     * есть, ход в ней допустим и позиция не повторяется. Обходится после поиска, поэтому
+     * перебор не тратит время на сохранение вариантов
+     */
+    vector<bit_move> principal_variation(bool color) const
+    {
+        vector<bit_move> pv;
+        const search_thread &main = *threads[0];
+        if (main.root_turns.empty())
+            return pv;
+        Position pos = main.pos;
+        move_list moves;
+        Position::undo_info undo;
+        vector<uint64_t> seen;
+        tt_stats counters;
+        tt_entry entry;
+        bit_move turn = main.root_turns[0];
+        while (true)
+        {
+            pv.push_back(turn);
+            seen.push_back(pos.key(color));
+            pos.do_move(turn, undo);
+            color = !color;
+            const uint64_t key = pos.key(color);
+            if (pv.size() >= size_t(MAX_PLY) || find(seen.begin(), seen.end(), key) != seen.end() ||
+                !tt.enabled() || !tt.probe(key, entry, counters))
+                break;
+            pos.gen_moves(color, moves);
+            if (find(moves.begin(), moves.end(), entry.move) == moves.end())
+                break;
+            turn = entry.move;
+        }
+        return pv;
+    }
+
+    // === СОРТИРОВКА ХОДОВ ===
+    // Ключ хода: ход из таблицы транспозиций, затем взятия (больше побитых фигур и дамок - раньше),
+    // превращения, ходы-убийцы уровня и остальные тихие ходы по таблице истории.
+    // Младшие 8 бит ключа - случайное число (при NoRandom = false), которое различает только равные ходы
+
+    static const int64_t ORDER_TT = int64_t(1) << 40;
+    static const int64_t ORDER_CAPTURE = int64_t(1) << 38;
+    static const int64_t ORDER_PROMOTION = int64_t(1) << 37;
+    static const int64_t ORDER_KILLER = int64_t(1) << 35;
+
+    void score_moves(search_thread &th, const bool color, const int ply, const bit_move &tt_move,
+                     const move_list &moves)
+    {
+        const Position &pos = th.pos;
+        auto &keys = th.ply_keys[ply];
+        for (int i = 0; i < moves.size; ++i)
+        {
+            const bit_move &turn = moves[i];
+            int64_t key;
+            if (turn == tt_move)
+                key = ORDER_TT;
+            else if (turn.beaten)
+                key = ORDER_CAPTURE + bit_count(turn.beaten) * 256 + bit_count(turn.beaten & pos.kings) * 4 +
+                      turn.promote * 2;
+            else if (turn.promote)
+                key = ORDER_PROMOTION;
+            else if (turn == th.killers[ply][0])
+                key = ORDER_KILLER * 2;
+            else if (turn == th.killers[ply][1])
+                key = ORDER_KILLER;
+            else
+                key = th.history[color][turn.from][turn.to];
+            keys[i] = key << 8 | (no_random ? 0 : th.rand_eng() & 255);
+        }
+    }
+
+    // Ставит на место i ход с наибольшим ключом среди оставшихся (ходы сортируются лениво,
+    // поэтому при раннем отсечении остаток списка не упорядочивается)
+    static const bit_move &pick_move(search_thread &th, const int ply, move_list &moves, const int i)
+    {
+        auto &keys = th.ply_keys[ply];
+        int best = i;
+        for (int j = i + 1; j < moves.size; ++j)
+        {
+            if (keys[j] > keys[best])
+                best = j;
+        }
+        swap(moves[i], moves[best]);
+        swap(keys[i], keys[best]);
+        return moves[i];
+    }
+
+    // Тихий ход дал отсечение: запоминаем его как убийцу уровня и поднимаем в таблице истории
+    static void update_quiet_stats(search_thread &th, const bool color, const int ply, const int depth,
+                                   const bit_move &turn)
+    {
+        if (th.killers[ply][0] != turn)
+        {
+            th.killers[ply][1] = th.killers[ply][0];
+            th.killers[ply][0] = turn;
+        }
+        uint32_t &value = th.history[color][turn.from][turn.to];
+        value = min<uint32_t>(value + uint32_t(depth * depth), uint32_t(1) << 30);
+    }
+
+    // Учет узла и проверка остановки. Время и флаг отмены проверяет главный поток раз в 1024 узла
+    bool check_stop(search_thread &th)
+    {
+        // При разделении корня главный поток может ждать помощников в join, поэтому пределы проверяет любой поток
+        if ((++th.nodes & 1023) == 0 && (th.id == 0 || exact_tt))
+            check_limits();
+        return stop->load(memory_order_relaxed);
+    }
+
+    // Отмена прерывает поиск сразу, бюджет времени - только после первой итерации.
+    // Размышление в ход соперника не ограничено по времени; после ponder_hit бюджет считается от начала
+    // размышления, поэтому если соперник думал дольше бюджета, ход делается сразу после текущей итерации
+    void check_limits()
+    {
+        if (cancel_token && cancel_token->load(memory_order_relaxed))
+        {
+            stop->store(true);
+            return;
+        }
+        if (!time_budget_ms)
+            return;
+        if (background->pondering.load(memory_order_relaxed))
+            return;
+        if (reached_depth && chrono::steady_clock::now() >= deadline)
+            stop->store(true);
+    }
+
+    // Запуск фонового потока поиска (pondering - размышление в ход соперника)
+    void run_background(const Position &pos, const bool color, const bool pondering, const vector<uint64_t> &history)
+    {
+        stop_search();
+        background_search &bg = *background;
+        bg.cancel = false;
+        bg.done = false;
+        bg.pondering = pondering;
+        bg.pos = pos;
+        bg.color = color;
+        bg.history = history;
+        bg.worker = thread([this, &bg]() {
+            bg.turns = find_best_turns(bg.pos, bg.color, &bg.cancel, bg.history);
+            bg.done = true;
+            if (notify)
+                notify(0);
+        });
+    }
+
+    /**
+     * Продление за горизонтом: пока у стороны есть взятия (а бить обязательно), позиция не оценивается
+     * и перебираются только взятия. Тихая позиция оценивается calc_score, позиция без ходов - проигрыш.
+     * Глубина продления ограничена QuiescenceDepth, после него позиция оценивается как есть
+     * @param qdepth число ходов, уже сделанных за горизонтом
+     */
+    template <class Scoring, class Pruning>
+    int quiescence(search_thread &th, const bool color, const int ply, const int qdepth, int alpha, int beta)
+    {
+        Position &pos = th.pos;
+        th.seldepth = max(th.seldepth, ply);
+        // Без фигур может остаться только сторона, делающая ход (последнюю фигуру побил соперник)
+        if (qdepth >= quiescence_depth || ply >= MAX_PLY - 1)
+            return (color ? pos.black : pos.white) ? calc_score<Scoring>(pos, true) : loss_score(color, ply);
+        if (qdepth > 0)
+        {
+            ++th.qnodes;
+            if (check_stop(th))
+                return 0;
+        }
+        move_list &moves = th.ply_moves[ply];
+        if (!pos.gen_moves(color, moves))
+            return moves.empty() ? loss_score(color, ply) : calc_score<Scoring>(pos, true);
+
+        score_moves(th, color, ply, bit_move(), moves);
+        int best_score = color ? -INF : INF;
+        Position::undo_info undo;
+        for (int i = 0; i < moves.size; ++i)
+        {
+            const bit_move turn = pick_move(th, ply, moves, i);
+            pos.do_move(turn, undo);
+            const int score = quiescence<Scoring, Pruning>(th, !color, ply + 1, qdepth + 1, alpha, beta);
+            pos.undo_move(turn, undo);
+            if (color ? score > best_score : score < best_score)
+                best_score = score;
+            if (color)
+                alpha = max(alpha, best_score);
+            else
+                beta = min(beta, best_score);
+            if (Pruning::alpha_beta(*this) && alpha >= beta)
+                break;
+        }
+        return best_score;
+    }
+
+    /**
+     * Записывает позицию уровня ply (ply > 0) в стек хешей потока.
+     * Позиция может повториться только после обратимых ходов (тихих ходов дамками), поэтому
+     * сравнивается лишь с позициями той же стороны после последнего необратимого хода
+     * @return true, если позиция уже встречалась в партии или на пути перебора
+     */
+    static bool repetition(search_thread &th, const int ply, const uint64_t key)
+    {
+        const int top = th.game_plies + ply;
+        th.key_stack[top] = key;
+        th.ply_material[ply] = th.pos.material;
+        th.reversible[ply] = th.pos.material == th.ply_material[ply - 1] ? th.reversible[ply - 1] + 1 : 0;
+        for (int i = 4; i <= th.reversible[ply]; i += 2)
+        {
+            if (th.key_stack[top - i] == key)
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * Рекурсивный минимакс с альфа-бета отсечением
+     * @param th поток поиска (позиция, буферы ходов, счетчики)
+     * @param color цвет стороны, делающей ход
+     * @param depth оставшаяся глубина в ходах (серия взятий - один ход)
+     * @param ply номер уровня для буферов ходов
+     * @param alpha нижняя граница оценки (гарантия черных)
+     * @param beta верхняя граница оценки (гарантия белых)
+     */
+    template <class Scoring, class Pruning>
+    int search(search_thread &th, const bool color, const int depth, const int ply, int alpha, int beta)
+    {
+        if (check_stop(th))
+            return 0;
+        Position &pos = th.pos;
+        th.seldepth = max(th.seldepth, ply);
+        const uint64_t key = pos.key(color);
+        if (repetition(th, ply, key))
+            return DRAW_SCORE;
+        // Позиция из таблиц эндшпиля оценивается точно, без перебора
+        uint8_t tb_value;
+        if (tablebase.probe(pos, color, tb_value))
+            return tablebase_score(color, tb_value, ply);
+        if (depth <= 0)
+            return quiescence<Scoring, Pruning>(th, color, ply, 0, alpha, beta);
+
+        // Таблица транспозиций (кроме режима "O0")
+        const bool use_tt = Pruning::alpha_beta(*this) && tt.enabled();
+        const int alpha_orig = alpha, beta_orig = beta;
+        tt_entry entry;
+        bool have_tt_move = false;
+        if (use_tt && tt.probe(key, entry, th.tt_counters))
+        {
+            have_tt_move = true;
+            if (exact_tt ? entry.depth == depth : entry.depth >= depth)
+            {
+                const int tt_score = score_from_tt(entry.score, ply);
+                if (entry.bound == TT_EXACT)
+                    return tt_score;
+                if (entry.bound == TT_LOWER)
+                    alpha = max(alpha, tt_score);
+                else
+                    beta = min(beta, tt_score);
+                if (alpha >= beta)
+                    return tt_score;
+            }
+        }
+
+        move_list &moves = th.ply_moves[ply];
+        const bool beats = pos.gen_moves(color, moves);
+        // Нет ходов - проигрыш стороны, делающей ход
+        if (moves.empty())
+            return loss_score(color, ply);
+        score_moves(th, color, ply, have_tt_move ? entry.move : bit_move(), moves);
+
+        // Отсечение бесперспективных ходов: тихий ход шашкой перед листом редко поднимает оценку до окна
+        const bool use_pvs = Pruning::o2(*this) && pvs_enabled;
+        const bool futile = Pruning::o2(*this) && futility_enabled && !beats && depth == 1 &&
+                            (color ? futility_bound<Scoring>(pos, color) <= alpha
+                                   : futility_bound<Scoring>(pos, color) >= beta);
+
+        int best_score = color ? -INF : INF;
+        bit_move best_move = moves[0];
+        Position::undo_info undo;
+        int searched = 0;
+        for (int i = 0; i < moves.size; ++i)
+        {
+            const bit_move turn = pick_move(th, ply, moves, i);
+            // Ход дамкой может повторить позицию или войти в таблицы (ничья выше оценки материала),
+            // ход, после которого соперник обязан бить, - начать комбинацию, а ход, после которого
+            // у соперника нет ходов, - выиграть: такие ходы не отсекаются
+            const bool prunable = futile && !turn.promote && !((pos.kings >> turn.from) & 1);
+            pos.do_move(turn, undo);
+            if (prunable && !pos.has_beats(!color) && pos.has_moves(!color))
+            {
+                pos.undo_move(turn, undo);
+                continue;
+            }
+            int score;
+            bool full_window = true;
+            // Поздние тихие ходы сначала проверяются на меньшей глубине
+            const bool reduce = Pruning::o2(*this) && lmr_enabled && !beats && !turn.promote && depth >= 3 && searched >= 3;
+            if (searched > 0 && (use_pvs || reduce))
+            {
+                // Нулевое окно вокруг текущей границы стороны, делающей ход
+                const int lo = color ? alpha : beta - 1;
+                const int hi = color ? alpha + 1 : beta;
+                score = search<Scoring, Pruning>(th, !color, depth - 1 - reduce, ply + 1, lo, hi);
+                bool improves = color ? score > alpha : score < beta;
+                if (reduce && improves && use_pvs)
                 {
-                    // Белые шашки получают бонус за приближение к дамочному полю
-                    w += 0.05 * (mtx[i][j] == 1) * (7 - i);
-                    // Черные шашки получают бонус за приближение к дамочному полю  
-                    b += 0.05 * (mtx[i][j] == 2) * (i);
+                    score = search<Scoring, Pruning>(th, !color, depth - 1, ply + 1, lo, hi);
+                    improves = color ? score > alpha : score < beta;
                 }
+                // Полное окно нужно, только если ход попал внутрь окна (а не дал отсечение)
+                full_window = improves && (color ? score < beta : score > alpha);
+                if (reduce && improves && !use_pvs)
+                    full_window = true;
+            }
+            if (full_window)
+                score = search<Scoring, Pruning>(th, !color, depth - 1, ply + 1, alpha, beta);
+            pos.undo_move(turn, undo);
+            ++searched;
+            if (color ? score > best_score : score < best_score)
+            {
+                best_score = score;
+                best_move = turn;
+            }
+            if (color)
+                alpha = max(alpha, best_score);
+            else
+                beta = min(beta, best_score);
+            if (Pruning::alpha_beta(*this) && alpha >= beta)
+            {
+                ++th.order_counters.cutoffs;
+                th.order_counters.first_move_cutoffs += searched == 1;
+                if (!beats)
+                    update_quiet_stats(th, color, ply, depth, turn);
+                break;
             }
         }
-        
-        // Если бот играет белыми - меняем местами оценки
-        if (!first_bot_color)
+        // Отсеченные ходы могли дать оценку не лучше границы - учитываем ее в возвращаемой оценке
+        if (futile)
         {
-            swap(b, w);
-            swap(bq, wq);
+            const int bound = futility_bound<Scoring>(pos, color);
+            best_score = color ? max(best_score, bound) : min(best_score, bound);
         }
-        
-        // Проверка терминальных состояний
-        if (w + wq == 0) // Противник проиграл
-            return INF;
-        if (b + bq == 0) // Бот проиграл
-            return 0;
-            
-        // Коэффициент ценности дамки относительно шашки
-        int q_coef = 4;
-        if (scoring_mode == "NumberAndPotential")
+        if (use_tt && !stop->load(memory_order_relaxed))
         {
-            q_coef = 5; // В этом режиме дамки ценятся выше
+            const tt_bound bound = best_score <= alpha_orig ? TT_UPPER
+                                   : best_score >= beta_orig ? TT_LOWER
+                                                             : TT_EXACT;
+            tt.store(key, depth, bound, score_to_tt(best_score, ply), best_move, th.tt_counters);
         }
-        
-        // Формула оценки: (фигуры бота) / (фигуры противника)
-        return (b + bq * q_coef) / (w + wq * q_coef);
+        return best_score;
     }
-
-    // УДАЛЕННЫЕ РЕАЛИЗАЦИИ ФУНКЦИЙ (по условию задачи):
-    // vector<move_pos> find_best_turns(const bool color)
-    // double find_first_best_turn(vector<vector<POS_T>> mtx, const bool color, const POS_T x, const POS_T y, size_t state, double alpha = -1)
-    // double find_best_turns_rec(vector<vector<POS_T>> mtx, const bool color, const size_t depth, double alpha = -1, double beta = INF + 1, const POS_T x = -1, const POS_T y = -1)
 };
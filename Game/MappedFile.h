@@ -0,0 +1,115 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+using namespace std;
+
+/**
+ * Файл, отображенный в память только для чтения (дебютная книга, таблицы эндшпиля).
+ * Данные читаются прямо из отображения: при открытии ничего не копируется и не разбирается,
+ * страницы подгружает система по мере обращения
+ */
+class MappedFile
+{
+  public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    // false, если файла нет или он пустой
+    bool open(const string &path)
+    {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || !file_size.QuadPart)
+        {
+            CloseHandle(file);
+            return false;
+        }
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file); // Отображение держит файл открытым само
+        if (!mapping)
+            return false;
+        mapped = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!mapped)
+        {
+            CloseHandle(mapping);
+            mapping = nullptr;
+            return false;
+        }
+        mapped_size = size_t(file_size.QuadPart);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) || !st.st_size)
+        {
+            ::close(fd);
+            return false;
+        }
+        void *addr = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // Отображение держит файл открытым само
+        if (addr == MAP_FAILED)
+            return false;
+        mapped = addr;
+        mapped_size = size_t(st.st_size);
+#endif
+        return true;
+    }
+
+    void close()
+    {
+        if (mapped)
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(mapped);
+            CloseHandle(mapping);
+            mapping = nullptr;
+#else
+            munmap(mapped, mapped_size);
+#endif
+        }
+        mapped = nullptr;
+        mapped_size = 0;
+    }
+
+    const char *data() const
+    {
+        return static_cast<const char *>(mapped);
+    }
+
+    size_t size() const
+    {
+        return mapped_size;
+    }
+
+  private:
+    void *mapped = nullptr; // Начало отображения (выровнено по странице)
+    size_t mapped_size = 0;
+#ifdef _WIN32
+    HANDLE mapping = nullptr; // Объект отображения
+#endif
+};
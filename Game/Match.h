@@ -0,0 +1,190 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include "../Models/Move.h"
+#include "Logic.h"
+#include "Position.h"
+
+// Статистика одного хода бота
+struct move_record
+{
+    double ms = 0;      // Время поиска в миллисекундах
+    uint64_t nodes = 0; // Просмотренные узлы
+    int depth = 0;      // Глубина последней завершенной итерации
+};
+
+// Итог одной партии бот против бота
+struct match_result
+{
+    int winner = -1;              // 0 - белые, 1 - черные, -1 - ничья
+    bool repetition = false;      // Ничья троекратным повторением позиции (а не по MaxNumTurns)
+    int turns = 0;                // Число сделанных ходов
+    vector<move_record> moves[2]; // Ходы белых и черных по порядку
+    uint64_t nodes[2] = {0, 0};   // Узлы перебора каждой стороны
+};
+
+/**
+ * Партия между двумя ботами без окна и задержек отрисовки.
+ * Правила окончания (Match::play): сторона без ходов проигрывает, после MaxNumTurns ходов
+ * объявляется ничья, партия заканчивается ничьей и тогда, когда позиция повторилась в третий раз
+ */
+class Match
+{
+  public:
+    Match(Logic *white, Logic *black, const int max_turns) : max_turns(max_turns)
+    {
+        bots[0] = white;
+        bots[1] = black;
+    }
+
+    /**
+     * Играет партию из позиции pos
+     * @param pos начальная позиция (например, после дебюта)
+     * @param color цвет стороны, делающей первый ход
+     */
+    match_result play(Position pos, bool color = 0) const
+    {
+        match_result res;
+        vector<uint64_t> history; // Позиции с последнего необратимого хода (взятия или хода шашкой)
+        for (; res.turns < max_turns; ++res.turns, color = !color)
+        {
+            Logic &bot = *bots[color];
+            auto start = chrono::steady_clock::now();
+            const vector<move_pos> steps = bot.find_best_turns(pos, color, nullptr, history);
+            auto end = chrono::steady_clock::now();
+            if (steps.empty())
+            {
+                res.winner = !color;
+                break;
+            }
+            move_record record;
+            record.ms = chrono::duration<double, milli>(end - start).count();
+            record.nodes = bot.nodes;
+            record.depth = bot.reached_depth;
+            res.moves[color].push_back(record);
+            res.nodes[color] += bot.nodes;
+            history.push_back(pos.key(color));
+            const material_counts before = pos.material;
+            Position::undo_info undo;
+            for (const auto &step : steps)
+                pos.do_move(to_bit_move(step), undo);
+            // После необратимого хода прежние позиции повториться не могут
+            if (!(pos.material == before))
+                history.clear();
+            if (count(history.begin(), history.end(), pos.key(!color)) >= 2)
+            {
+                ++res.turns;
+                res.repetition = true;
+                break;
+            }
+        }
+        return res;
+    }
+
+  private:
+    Logic *bots[2];
+    int max_turns;
+};
+
+// Дебют из plies случайных ходов от начальной расстановки; color - сторона, делающая ход после дебюта
+inline Position random_opening(mt19937 &rng, const int plies, bool &color)
+{
+    Position pos = Position::start();
+    color = 0;
+    move_list moves;
+    Position::undo_info undo;
+    for (int ply = 0; ply < plies; ++ply, color = !color)
+    {
+        pos.gen_moves(color, moves);
+        if (moves.empty())
+            break;
+        pos.do_move(moves[rng() % moves.size], undo);
+    }
+    return pos;
+}
+
+// Обход дерева ходов для opening_suite: позиции на глубине plies без повторов
+inline void collect_openings(Position &pos, const int ply, const int plies, vector<move_list> &moves,
+                             unordered_set<uint64_t> &seen, vector<Position> &suite)
+{
+    if (ply == plies)
+    {
+        if (seen.insert(pos.key(ply & 1)).second)
+            suite.push_back(pos);
+        return;
+    }
+    pos.gen_moves(ply & 1, moves[ply]);
+    Position::undo_info undo;
+    for (const auto &turn : moves[ply])
+    {
+        pos.do_move(turn, undo);
+        collect_openings(pos, ply + 1, plies, moves, seen, suite);
+        pos.undo_move(turn, undo);
+    }
+}
+
+/**
+ * Набор дебютов: все различные позиции после plies ходов от начальной расстановки
+ * (позиции, достижимые разными путями, входят один раз). Ходит сторона plies % 2
+ */
+inline vector<Position> opening_suite(const int plies)
+{
+    vector<Position> suite;
+    unordered_set<uint64_t> seen;
+    vector<move_list> moves(plies);
+    Position pos = Position::start();
+    collect_openings(pos, 0, plies, moves, seen, suite);
+    return suite;
+}
+
+/**
+ * Разница в рейтинге Эло по результату серии партий (выигрыш 1, ничья 0.5)
+ * @param error полуширина 95% доверительного интервала
+ * @return оценка разницы Эло первой стороны относительно второй
+ */
+inline double elo_difference(const int wins, const int draws, const int losses, double &error)
+{
+    const int games = wins + draws + losses;
+    auto elo = [](double score) {
+        score = min(max(score, 1e-3), 1 - 1e-3);
+        return score == 0.5 ? 0.0 : -400 * log10(1 / score - 1);
+    };
+    if (!games)
+    {
+        error = 0;
+        return 0;
+    }
+    const double score = (wins + 0.5 * draws) / games;
+    const double variance =
+        (wins * pow(1 - score, 2) + draws * pow(0.5 - score, 2) + losses * pow(score, 2)) / games;
+    const double margin = 1.96 * sqrt(variance / games);
+    error = (elo(score + margin) - elo(score - margin)) / 2;
+    return elo(score);
+}
+
+/**
+ * Логарифм отношения правдоподобия последовательного теста (SPRT) для гипотез
+ * H0: разница Эло = elo0 и H1: разница Эло = elo1 по итогам серии партий
+ * (нормальное приближение для результатов партий с ничьими)
+ */
+inline double sprt_llr(const int wins, const int draws, const int losses, const double elo0, const double elo1)
+{
+    if (!(wins + draws + losses))
+        return 0;
+    // К каждому исходу добавляется половина партии: серия без побед или без поражений
+    // остается свидетельством (а не дает нулевую дисперсию)
+    const double w = wins + 0.5, d = draws + 0.5, l = losses + 0.5;
+    const double games = w + d + l;
+    const double score = (w + 0.5 * d) / games;
+    const double variance = (w * pow(1 - score, 2) + d * pow(0.5 - score, 2) + l * pow(score, 2)) / games;
+    if (variance <= 0)
+        return 0;
+    auto expected = [](const double elo) { return 1 / (1 + pow(10, -elo / 400)); };
+    const double s0 = expected(elo0), s1 = expected(elo1);
+    return games * (s1 - s0) * (2 * score - s0 - s1) / (2 * variance);
+}
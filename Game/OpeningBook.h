@@ -0,0 +1,148 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "MappedFile.h"
+#include "Position.h"
+
+using namespace std;
+
+// Запись книги: ход в позиции. Ход задан клетками и маской побитых фигур, как bit_move без превращения
+struct book_entry
+{
+    uint64_t key;     // Position::key(color) позиции, в которой делается ход
+    uint32_t beaten;  // Побитые фигуры
+    uint8_t from, to; // Откуда и куда
+    uint16_t weight;  // Вес хода: без NoRandom ход выбирается с вероятностью, пропорциональной весу
+};
+static_assert(sizeof(book_entry) == 16, "book_entry is stored in the file as is");
+
+// Заголовок файла книги
+struct book_header
+{
+    char magic[8];    // BOOK_MAGIC
+    uint16_t version; // BOOK_VERSION
+    uint16_t level;   // Уровень бота, которым искались ходы книги (--level book_builder)
+    uint32_t count;   // Число записей после заголовка
+};
+static_assert(sizeof(book_header) == 16, "book_header is stored in the file as is");
+
+const char BOOK_MAGIC[8] = {'C', 'K', 'R', 'S', 'B', 'O', 'O', 'K'};
+const uint16_t BOOK_VERSION = 2;
+
+/**
+ * Дебютная книга (строит Tools/book_builder.cpp). Файл - заголовок и массив book_entry,
+ * отсортированный по ключу позиции, а ходы одной позиции - по убыванию веса. Файл отображается
+ * в память как есть и ничего не разбирает при загрузке; поиск позиции - двоичный поиск по ключу.
+ * Записи в порядке байтов машины, на которой построена книга (little-endian)
+ */
+class OpeningBook
+{
+  public:
+    // Открывает книгу; false, если файла нет или он не является книгой (книга остается пустой)
+    bool open(const string &path)
+    {
+        close();
+        if (path.empty() || !file.open(path))
+            return false;
+        book_header header;
+        if (file.size() < sizeof(header))
+        {
+            close();
+            return false;
+        }
+        memcpy(&header, file.data(), sizeof(header));
+        if (memcmp(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) || header.version != BOOK_VERSION ||
+            file.size() < sizeof(header) + size_t(header.count) * sizeof(book_entry))
+        {
+            close();
+            return false;
+        }
+        entries = reinterpret_cast<const book_entry *>(file.data() + sizeof(header));
+        count = header.count;
+        book_level = header.level;
+        return true;
+    }
+
+    void close()
+    {
+        file.close();
+        entries = nullptr;
+        count = 0;
+        book_level = 0;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    // Уровень, на котором построена книга: боту меньшего уровня ее ходы слишком сильны
+    int level() const
+    {
+        return book_level;
+    }
+
+    /**
+     * Ход книги для позиции pos, где ходит color. Ходы книги сверяются с допустимыми ходами позиции,
+     * поэтому совпадение хеша другой позиции не дает недопустимого хода
+     * @param rng генератор для выбора по весам; nullptr - всегда ход с наибольшим весом (NoRandom)
+     * @return false, если позиции нет в книге
+     */
+    bool probe(const Position &pos, const bool color, default_random_engine *rng, bit_move &turn) const
+    {
+        const uint64_t key = pos.key(color);
+        const book_entry *first = lower_bound(entries, entries + count, key,
+                                              [](const book_entry &e, const uint64_t k) { return e.key < k; });
+        const book_entry *last = first;
+        while (last != entries + count && last->key == key)
+            ++last;
+        if (first == last)
+            return false;
+
+        move_list moves;
+        pos.gen_moves(color, moves);
+        bit_move candidates[move_list::MAX_SIZE];
+        uint32_t weights[move_list::MAX_SIZE];
+        int size = 0;
+        uint32_t total = 0;
+        for (const book_entry *e = first; e != last && size < move_list::MAX_SIZE; ++e)
+        {
+            for (const auto &m : moves)
+            {
+                if (m.from == e->from && m.to == e->to && m.beaten == e->beaten)
+                {
+                    candidates[size] = m;
+                    weights[size++] = e->weight;
+                    total += e->weight;
+                    break;
+                }
+            }
+        }
+        if (!size)
+            return false;
+        int chosen = 0;
+        if (rng && total)
+        {
+            uint32_t r = uniform_int_distribution<uint32_t>(0, total - 1)(*rng);
+            while (r >= weights[chosen])
+                r -= weights[chosen++];
+        }
+        turn = candidates[chosen];
+        return true;
+    }
+
+  private:
+    MappedFile file;                    // Отображенный в память файл книги
+    const book_entry *entries = nullptr; // Записи сразу после заголовка
+    size_t count = 0;
+    int book_level = 0;
+};
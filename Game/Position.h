@@ -0,0 +1,659 @@
+#pragma once
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../Models/Move.h"
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+using namespace std;
+
+// Битовая маска игровых (темных) клеток доски.
+// Клетка (x, y) хранится в бите s = 4 * x + y / 2, то есть по 4 бита на строку:
+// в четных строках игровые клетки y = 1, 3, 5, 7, в нечетных - y = 0, 2, 4, 6
+typedef uint32_t BB;
+
+const BB EVEN_ROWS = 0x0F0F0F0F; // Строки 0, 2, 4, 6
+const BB ODD_ROWS = 0xF0F0F0F0;  // Строки 1, 3, 5, 7
+const BB LEFT_COL = 0x11111111;  // Крайняя левая игровая клетка каждой строки
+const BB RIGHT_COL = 0x88888888; // Крайняя правая игровая клетка каждой строки
+const BB TOP_ROW = 0x0000000F;    // Строка 0 - дамочное поле белых
+const BB BOTTOM_ROW = 0xF0000000; // Строка 7 - дамочное поле черных
+
+// Направления по диагонали: 0 - (x-1, y-1), 1 - (x-1, y+1), 2 - (x+1, y-1), 3 - (x+1, y+1).
+// Противоположное направление для dir - это 3 - dir
+inline BB shift(const BB b, const int dir)
+{
+    switch (dir)
+    {
+    case 0:
+        return ((b & EVEN_ROWS) >> 4) | ((b & ODD_ROWS & ~LEFT_COL) >> 5);
+    case 1:
+        return ((b & EVEN_ROWS & ~RIGHT_COL) >> 3) | ((b & ODD_ROWS) >> 4);
+    case 2:
+        return ((b & EVEN_ROWS) << 4) | ((b & ODD_ROWS & ~LEFT_COL) << 3);
+    default:
+        return ((b & EVEN_ROWS & ~RIGHT_COL) << 5) | ((b & ODD_ROWS) << 4);
+    }
+}
+
+// Количество установленных битов
+inline int bit_count(const BB b)
+{
+#ifdef _MSC_VER
+    return int(__popcnt(b));
+#else
+    return __builtin_popcount(b);
+#endif
+}
+
+// Индекс младшего установленного бита (b != 0)
+inline int bit_first(const BB b)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward(&idx, b);
+    return int(idx);
+#else
+    return __builtin_ctz(b);
+#endif
+}
+
+// Ключи Зобриста: по ключу на (тип фигуры, клетку) и ключ стороны, делающей ход.
+// Генерируются детерминированно (splitmix64 с фиксированным seed), поэтому хеш позиции
+// одинаков между запусками и может храниться в файлах
+struct zobrist_table
+{
+    uint64_t piece[4][32]; // Тип фигуры - 1 (0 - белая шашка, 1 - черная шашка, 2 - белая дамка, 3 - черная дамка)
+    uint64_t side;         // Добавляется к хешу, когда ходят черные
+};
+
+constexpr uint64_t splitmix64(uint64_t &state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+constexpr zobrist_table make_zobrist()
+{
+    zobrist_table table{};
+    uint64_t state = 20240601;
+    for (int type = 0; type < 4; ++type)
+        for (int s = 0; s < 32; ++s)
+            table.piece[type][s] = splitmix64(state);
+    table.side = splitmix64(state);
+    return table;
+}
+
+constexpr zobrist_table ZOBRIST = make_zobrist();
+
+// Перевод между координатами матрицы и индексом игровой клетки
+inline uint8_t to_square(const POS_T x, const POS_T y)
+{
+    return uint8_t(x * 4 + y / 2);
+}
+inline POS_T square_x(const int s)
+{
+    return POS_T(s >> 2);
+}
+inline POS_T square_y(const int s)
+{
+    return POS_T(2 * (s & 3) + !((s >> 2) & 1));
+}
+
+// Перевод хода из координат матрицы в ход битовой доски
+inline bit_move to_bit_move(const move_pos &turn)
+{
+    return bit_move(to_square(turn.x, turn.y), to_square(turn.x2, turn.y2),
+                    turn.xb == -1 ? 0 : BB(1) << to_square(turn.xb, turn.yb));
+}
+
+// Запись хода для журналов и утилит: 22-17, взятие - 22x13 (клетки нумеруются как в Position::to_fen)
+inline string move_notation(const bit_move &turn)
+{
+    return to_string(turn.from + 1) + (turn.beaten ? "x" : "-") + to_string(turn.to + 1);
+}
+
+// Продвижение шашки цвета color на клетке s: число строк, пройденных от своего края доски
+inline int advancement(const bool color, const int s)
+{
+    return color ? s >> 2 : 7 - (s >> 2);
+}
+
+// Счетчики для оценки позиции, индекс - цвет (0 - белые, 1 - черные)
+struct material_counts
+{
+    int8_t men[2] = {0, 0};    // Шашки
+    int8_t kings[2] = {0, 0};  // Дамки
+    int16_t steps[2] = {0, 0}; // Сумма продвижения шашек (advancement)
+
+    // Материал не меняется только при тихом ходе дамкой: взятие, превращение и ход шашкой необратимы
+    bool operator==(const material_counts &other) const
+    {
+        return !memcmp(this, &other, sizeof(material_counts));
+    }
+};
+
+// Позиция на битовой доске: маски белых, черных фигур и дамок обоих цветов
+class Position
+{
+  public:
+    BB white = 0; // Белые фигуры (шашки и дамки)
+    BB black = 0; // Черные фигуры (шашки и дамки)
+    BB kings = 0; // Дамки обоих цветов
+    uint64_t hash = 0; // Хеш Зобриста расстановки (без учета стороны, делающей ход)
+    material_counts material; // Материал и продвижение, обновляются в do_move/undo_move
+
+    Position() = default;
+
+    // Построение позиции по матрице доски (формат Board::get_board())
+    explicit Position(const vector<vector<POS_T>> &mtx)
+    {
+        for (POS_T i = 0; i < 8; ++i)
+        {
+            for (POS_T j = 0; j < 8; ++j)
+            {
+                if (!mtx[i][j])
+                    continue;
+                const BB bit = BB(1) << to_square(i, j);
+                if (mtx[i][j] % 2)
+                    white |= bit;
+                else
+                    black |= bit;
+                if (mtx[i][j] > 2)
+                    kings |= bit;
+            }
+        }
+        rehash();
+    }
+
+    // Начальная расстановка (как в Board::make_start_mtx): черные в строках 0-2, белые в строках 5-7
+    static Position start()
+    {
+        Position pos;
+        pos.black = 0x00000FFF;
+        pos.white = 0xFFF00000;
+        pos.rehash();
+        return pos;
+    }
+
+    // Пересчет хеша и счетчиков материала с нуля (после прямого изменения масок)
+    void rehash()
+    {
+        hash = 0;
+        material = material_counts();
+        for (BB all = white | black; all; all &= all - 1)
+        {
+            const int s = bit_first(all);
+            const bool color = (black >> s) & 1, king = (kings >> s) & 1;
+            hash ^= ZOBRIST.piece[color + king * 2][s];
+            if (king)
+                ++material.kings[color];
+            else
+            {
+                ++material.men[color];
+                material.steps[color] += advancement(color, s);
+            }
+        }
+    }
+
+    // Хеш позиции с учетом стороны, делающей ход
+    uint64_t key(const bool color) const
+    {
+        return color ? hash ^ ZOBRIST.side : hash;
+    }
+
+    /**
+     * Текстовая запись позиции по образцу FEN из PDN: "W:W21,22,K30:B1,2,K3".
+     * Первая буква - сторона, делающая ход, затем списки белых и черных фигур; K перед номером - дамка.
+     * Клетки нумеруются от 1 до 32 со стороны черных: номер клетки s - это s + 1
+     */
+    string to_fen(const bool color) const
+    {
+        string fen = color ? "B" : "W";
+        for (const bool side : {false, true})
+        {
+            fen += side ? ":B" : ":W";
+            bool first = true;
+            for (BB b = pieces(side); b; b &= b - 1)
+            {
+                const int s = bit_first(b);
+                fen += first ? "" : ",";
+                fen += ((kings >> s) & 1) ? "K" : "";
+                fen += to_string(s + 1);
+                first = false;
+            }
+        }
+        return fen;
+    }
+
+    // Разбор записи to_fen; false, если запись некорректна
+    static bool from_fen(const string &fen, Position &pos, bool &color)
+    {
+        pos = Position();
+        if (fen.empty() || (fen[0] != 'W' && fen[0] != 'B'))
+            return false;
+        color = fen[0] == 'B';
+        size_t i = 1;
+        while (i < fen.size())
+        {
+            if (fen[i] != ':' || i + 1 >= fen.size() || (fen[i + 1] != 'W' && fen[i + 1] != 'B'))
+                return false;
+            BB &side = fen[i + 1] == 'B' ? pos.black : pos.white;
+            i += 2;
+            while (i < fen.size() && fen[i] != ':')
+            {
+                const bool king = fen[i] == 'K';
+                i += king;
+                int number = 0, digits = 0;
+                for (; i < fen.size() && isdigit((unsigned char)fen[i]); ++i, ++digits)
+                    number = number * 10 + (fen[i] - '0');
+                if (!digits || number < 1 || number > 32)
+                    return false;
+                const BB bit = BB(1) << (number - 1);
+                if ((pos.white | pos.black) & bit)
+                    return false;
+                side |= bit;
+                if (king)
+                    pos.kings |= bit;
+                if (i < fen.size() && fen[i] == ',')
+                    ++i;
+            }
+        }
+        pos.rehash();
+        return true;
+    }
+
+    // Обратное преобразование в матрицу доски
+    vector<vector<POS_T>> to_mtx() const
+    {
+        vector<vector<POS_T>> mtx(8, vector<POS_T>(8, 0));
+        for (int s = 0; s < 32; ++s)
+            mtx[square_x(s)][square_y(s)] = piece(s);
+        return mtx;
+    }
+
+    // Тип фигуры на клетке в кодировке матрицы: 0 - пусто, 1/2 - белая/черная шашка, 3/4 - белая/черная дамка
+    POS_T piece(const int s) const
+    {
+        const BB bit = BB(1) << s;
+        if (!((white | black) & bit))
+            return 0;
+        return POS_T(((black & bit) ? 2 : 1) + ((kings & bit) ? 2 : 0));
+    }
+
+    BB pieces(const bool color) const
+    {
+        return color ? black : white;
+    }
+    BB empty() const
+    {
+        return ~(white | black);
+    }
+
+    /**
+     * Генерирует все ходы стороны color (0 - белые, 1 - черные).
+     * Если есть хотя бы одно взятие - возвращаются только взятия, каждое - полной серией
+     * (совпадающие по результату пути серии дают один ход)
+     * @return true если найденные ходы являются взятиями
+     */
+    bool gen_moves(const bool color, move_list &moves) const
+    {
+        moves.clear();
+        if (gen_beats(color, pieces(color), moves, true))
+            return true;
+        gen_quiet(color, moves);
+        return false;
+    }
+
+    // То же, но взятия - только первым прыжком серии (для интерфейса, где игрок бьет по одной фигуре)
+    bool gen_steps(const bool color, move_list &moves) const
+    {
+        moves.clear();
+        if (gen_beats(color, pieces(color), moves, false))
+            return true;
+        gen_quiet(color, moves);
+        return false;
+    }
+
+    // Есть ли у стороны color взятие (без генерации ходов: для проверок в переборе)
+    bool has_beats(const bool color) const
+    {
+        const BB own = pieces(color), opp = pieces(!color), free = empty();
+        const BB men = own & ~kings;
+        for (int dir = 0; dir < 4; ++dir)
+        {
+            if (shift(shift(men, dir) & opp, dir) & free)
+                return true;
+        }
+        for (BB queens = own & kings; queens; queens &= queens - 1)
+        {
+            const BB from = queens & (0 - queens);
+            for (int dir = 0; dir < 4; ++dir)
+            {
+                BB t = shift(from, dir);
+                while (t & free)
+                    t = shift(t, dir);
+                if ((t & opp) && (shift(t, dir) & free))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    // Есть ли у стороны color хоть один ход (без генерации ходов: для проверок в переборе)
+    bool has_moves(const bool color) const
+    {
+        const BB own = pieces(color), free = empty();
+        const BB queens = own & kings;
+        for (int dir = 0; dir < 4; ++dir)
+        {
+            // Шашки ходят без взятия только вперед, дамки - в любую сторону
+            const bool forward = color ? dir >= 2 : dir < 2;
+            if (shift(forward ? own : queens, dir) & free)
+                return true;
+        }
+        return has_beats(color);
+    }
+
+    /**
+     * Генерирует ходы одной фигуры на клетке s по одному прыжку (для продолжения серии взятий в интерфейсе)
+     * @return true если найденные ходы являются взятиями
+     */
+    bool gen_piece_moves(const int s, move_list &moves) const
+    {
+        moves.clear();
+        const BB bit = BB(1) << s;
+        const bool color = (black & bit) != 0;
+        if (gen_beats(color, bit, moves, false))
+            return true;
+        gen_quiet(color, moves, bit);
+        return false;
+    }
+
+    /**
+     * Раскладывает ход из gen_moves на отдельные прыжки, как их делает игрок (для анимации хода бота)
+     * @return последовательность ходов по одному прыжку; тихий ход возвращается как есть
+     */
+    vector<bit_move> chain_steps(const bit_move &turn) const
+    {
+        vector<bit_move> steps;
+        if (!turn.beaten)
+            return {turn};
+        Position pos = *this;
+        pos.find_chain(turn, turn.from, steps);
+        return steps;
+    }
+
+    // Информация для точного отката хода
+    struct undo_info
+    {
+        BB beaten_kings = 0;   // Какие из побитых фигур были дамками
+        bool promoted = false; // Шашка превратилась в дамку этим ходом
+        uint64_t hash = 0;     // Хеш до хода
+        material_counts material; // Счетчики материала до хода
+    };
+
+    /**
+     * Выполняет ход на месте: побитая фигура снимается, шашка на последней строке становится дамкой
+     * @param turn ход для выполнения
+     * @param undo заполняется данными для undo_move
+     */
+    void do_move(const bit_move &turn, undo_info &undo)
+    {
+        const BB from = BB(1) << turn.from, to = BB(1) << turn.to;
+        const bool color = (black & from) != 0;
+        BB &own = color ? black : white;
+        BB &opp = color ? white : black;
+        undo.beaten_kings = kings & turn.beaten;
+        undo.hash = hash;
+        undo.material = material;
+        // Снятие побитых фигур с хеша: тип 1 - шашка противника, тип 3 - дамка противника
+        for (BB b = turn.beaten; b; b &= b - 1)
+        {
+            const int s = bit_first(b);
+            const bool king = (kings >> s) & 1;
+            hash ^= ZOBRIST.piece[!color + king * 2][s];
+            if (king)
+                --material.kings[!color];
+            else
+            {
+                --material.men[!color];
+                material.steps[!color] -= advancement(!color, s);
+            }
+        }
+        opp &= ~turn.beaten;
+        kings &= ~turn.beaten;
+        // Серия взятий может закончиться на исходной клетке, поэтому from и to не объединяются в одну маску
+        own = (own & ~from) | to;
+        undo.promoted = false;
+        const bool was_king = (kings & from) != 0;
+        if (was_king)
+            kings = (kings & ~from) | to;
+        else if (turn.promote || (to & (color ? BOTTOM_ROW : TOP_ROW)))
+        {
+            kings |= to;
+            undo.promoted = true;
+        }
+        if (undo.promoted)
+        {
+            --material.men[color];
+            ++material.kings[color];
+            material.steps[color] -= advancement(color, turn.from);
+        }
+        else if (!was_king)
+            material.steps[color] += advancement(color, turn.to) - advancement(color, turn.from);
+        hash ^= ZOBRIST.piece[color + was_king * 2][turn.from] ^
+                ZOBRIST.piece[color + (was_king || undo.promoted) * 2][turn.to];
+    }
+
+    // Откатывает ход, выполненный do_move, восстанавливая побитые фигуры и превращение
+    void undo_move(const bit_move &turn, const undo_info &undo)
+    {
+        const BB from = BB(1) << turn.from, to = BB(1) << turn.to;
+        const bool color = (black & to) != 0;
+        BB &own = color ? black : white;
+        BB &opp = color ? white : black;
+        own = (own & ~to) | from;
+        if (undo.promoted)
+            kings &= ~to;
+        else if (kings & to)
+            kings = (kings & ~to) | from;
+        opp |= turn.beaten;
+        kings |= undo.beaten_kings;
+        hash = undo.hash;
+        material = undo.material;
+    }
+
+  private:
+    /**
+     * Взятия фигурами из маски movers. Шашки бьют во все 4 стороны, дамки - на любое расстояние
+     * @param chains true - полные серии взятий, false - только первый прыжок серии
+     */
+    bool gen_beats(const bool color, const BB movers, move_list &moves, const bool chains) const
+    {
+        const BB opp = pieces(!color), free = empty();
+        const BB men = movers & ~kings;
+        const BB promotion_row = color ? BOTTOM_ROW : TOP_ROW;
+        const int before = moves.size;
+        BB jumpers = 0; // Шашки, у которых есть хотя бы один прыжок
+        for (int dir = 0; dir < 4; ++dir)
+        {
+            BB landings = shift(shift(men, dir) & opp, dir) & free;
+            if (chains)
+            {
+                jumpers |= shift(shift(landings, 3 - dir), 3 - dir);
+                continue;
+            }
+            while (landings)
+            {
+                const BB to = landings & (0 - landings);
+                landings ^= to;
+                const BB beaten = shift(to, 3 - dir);
+                moves.emplace_back(bit_first(shift(beaten, 3 - dir)), bit_first(to), beaten, (to & promotion_row) != 0);
+            }
+        }
+        if (chains)
+        {
+            for (BB b = jumpers | (movers & kings); b; b &= b - 1)
+            {
+                const int s = bit_first(b);
+                gen_chain(color, s, s, (kings >> s) & 1, opp, free, 0, false, moves.size, moves);
+            }
+            return moves.size != before;
+        }
+        for (BB queens = movers & kings; queens; queens &= queens - 1)
+        {
+            const BB from = queens & (0 - queens);
+            for (int dir = 0; dir < 4; ++dir)
+            {
+                BB t = shift(from, dir);
+                while (t & free)
+                    t = shift(t, dir);
+                if (!(t & opp))
+                    continue;
+                const BB beaten = t;
+                for (t = shift(t, dir); t & free; t = shift(t, dir))
+                    moves.emplace_back(bit_first(from), bit_first(t), beaten);
+            }
+        }
+        return moves.size != before;
+    }
+
+    /**
+     * Продолжение серии взятий фигурой на клетке sq (начало серии - клетка from).
+     * Побитые фигуры снимаются сразу, шашка, дошедшая до последней строки, дальше бьет как дамка
+     * @param opp еще не побитые фигуры противника
+     * @param free свободные клетки после сделанных прыжков
+     * @param first индекс первого хода фигуры from в moves (для отбрасывания повторов)
+     */
+    static void gen_chain(const bool color, const int from, const int sq, const bool king, const BB opp,
+                          const BB free, const BB beaten, const bool promoted, const int first, move_list &moves)
+    {
+        const BB bit = BB(1) << sq;
+        const BB promotion_row = color ? BOTTOM_ROW : TOP_ROW;
+        bool extended = false;
+        for (int dir = 0; dir < 4; ++dir)
+        {
+            if (!king)
+            {
+                const BB victim = shift(bit, dir) & opp;
+                const BB landing = shift(victim, dir) & free;
+                if (!landing)
+                    continue;
+                extended = true;
+                const bool promote = (landing & promotion_row) != 0;
+                gen_chain(color, from, bit_first(landing), promote, opp & ~victim, (free | victim | bit) & ~landing,
+                          beaten | victim, promoted || promote, first, moves);
+                continue;
+            }
+            BB t = shift(bit, dir);
+            while (t & free)
+                t = shift(t, dir);
+            if (!(t & opp))
+                continue;
+            const BB victim = t;
+            for (t = shift(t, dir); t & free; t = shift(t, dir))
+            {
+                extended = true;
+                gen_chain(color, from, bit_first(t), true, opp & ~victim, (free | victim | bit) & ~t, beaten | victim,
+                          promoted, first, moves);
+            }
+        }
+        if (extended || !beaten)
+            return;
+        const bit_move turn(from, sq, beaten, promoted);
+        for (int i = first; i < moves.size; ++i)
+        {
+            if (moves[i] == turn)
+                return;
+        }
+        if (moves.size < move_list::MAX_SIZE)
+            moves.moves[moves.size++] = turn;
+    }
+
+    // Поиск пути прыжков от клетки sq, дающего ход turn (для chain_steps). Позиция меняется по ходу поиска
+    bool find_chain(const bit_move &turn, const int sq, vector<bit_move> &steps)
+    {
+        move_list moves;
+        if (!gen_piece_moves(sq, moves))
+        {
+            BB beaten = 0;
+            bool promoted = false;
+            for (const auto &step : steps)
+            {
+                beaten |= step.beaten;
+                promoted = promoted || step.promote;
+            }
+            return sq == turn.to && beaten == turn.beaten && promoted == turn.promote;
+        }
+        undo_info undo;
+        for (const auto &step : moves)
+        {
+            if (!(step.beaten & turn.beaten))
+                continue;
+            do_move(step, undo);
+            steps.push_back(step);
+            if (find_chain(turn, step.to, steps))
+                return true;
+            steps.pop_back();
+            undo_move(step, undo);
+        }
+        return false;
+    }
+
+    // Тихие ходы: шашки только вперед (белые - к строке 0, черные - к строке 7), дамки на любое расстояние
+    void gen_quiet(const bool color, move_list &moves, const BB movers = ~BB(0)) const
+    {
+        const BB own = pieces(color) & movers, free = empty();
+        const BB men = own & ~kings;
+        const BB promotion_row = color ? BOTTOM_ROW : TOP_ROW;
+        for (int dir = color ? 2 : 0; dir < (color ? 4 : 2); ++dir)
+        {
+            for (BB targets = shift(men, dir) & free; targets; targets &= targets - 1)
+            {
+                const BB to = targets & (0 - targets);
+                moves.emplace_back(bit_first(shift(to, 3 - dir)), bit_first(to), 0, (to & promotion_row) != 0);
+            }
+        }
+        for (BB queens = own & kings; queens; queens &= queens - 1)
+        {
+            const BB from = queens & (0 - queens);
+            for (int dir = 0; dir < 4; ++dir)
+            {
+                for (BB t = shift(from, dir); t & free; t = shift(t, dir))
+                    moves.emplace_back(bit_first(from), bit_first(t));
+            }
+        }
+    }
+};
+
+/**
+ * Число листьев дерева ходов глубины depth (серия взятий - один ход, совпадающие по результату пути
+ * серии считаются одним ходом). Позиция меняется на месте через do_move/undo_move и восстанавливается
+ * @param moves буферы ходов по уровням, не меньше depth штук
+ */
+inline uint64_t perft(Position &pos, const bool color, const int depth, move_list *moves)
+{
+    if (depth == 0)
+        return 1;
+    pos.gen_moves(color, moves[0]);
+    if (depth == 1)
+        return uint64_t(moves[0].size);
+    uint64_t nodes = 0;
+    Position::undo_info undo;
+    for (const auto &turn : moves[0])
+    {
+        pos.do_move(turn, undo);
+        nodes += perft(pos, !color, depth - 1, moves + 1);
+        pos.undo_move(turn, undo);
+    }
+    return nodes;
+}
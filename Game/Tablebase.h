@@ -0,0 +1,210 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "MappedFile.h"
+#include "Position.h"
+
+using namespace std;
+
+/**
+ * Таблицы эндшпиля из одних дамок (строит Tools/tablebase_gen.cpp).
+ * Дамки обоих цветов ходят одинаково и не превращаются, поэтому позиция, где ходят черные,
+ * совпадает с позицией, где ходят белые, после обмена цветов: таблица хранится только
+ * для стороны, делающей ход, и задается числом ее дамок (mover) и дамок соперника (other).
+ * Взятие переводит позицию в таблицу с меньшим числом фигур, других переходов между таблицами нет.
+ *
+ * Значение позиции - байт: 0 - ничья, иначе расстояние до конца партии в ходах + 1
+ * (серия взятий - один ход). Нечетное расстояние - выигрыш стороны, делающей ход, четное - проигрыш
+ * (0 - у стороны нет ходов)
+ */
+
+const int TB_MAX_PIECES = 8; // Предел числа фигур, для которого считается индекс
+
+// Биномиальные коэффициенты C(n, k) для n <= 32, k <= TB_MAX_PIECES (индексация сочетаний клеток)
+struct binomial_table
+{
+    uint32_t c[33][TB_MAX_PIECES + 1];
+};
+
+constexpr binomial_table make_binomials()
+{
+    binomial_table table{};
+    for (int n = 0; n <= 32; ++n)
+    {
+        table.c[n][0] = 1;
+        for (int k = 1; k <= TB_MAX_PIECES; ++k)
+            table.c[n][k] = n ? table.c[n - 1][k - 1] + table.c[n - 1][k] : 0;
+    }
+    return table;
+}
+
+constexpr binomial_table BINOMIAL = make_binomials();
+
+// Число позиций таблицы: дамки стороны, делающей ход, на любых mover клетках, дамки соперника - на остальных
+inline uint64_t tb_size(const int mover, const int other)
+{
+    return uint64_t(BINOMIAL.c[32][mover]) * BINOMIAL.c[32 - mover][other];
+}
+
+/**
+ * Индекс позиции в таблице: номер сочетания клеток своих дамок (в колексикографическом порядке),
+ * умноженный на число сочетаний клеток соперника, плюс номер сочетания клеток соперника
+ * среди клеток, не занятых своими дамками
+ */
+inline uint64_t tb_index(const BB mover, const BB other)
+{
+    uint64_t own = 0, rest = 0;
+    int k = 0;
+    for (BB b = mover; b; b &= b - 1)
+        own += BINOMIAL.c[bit_first(b)][++k];
+    const int mover_count = k;
+    k = 0;
+    for (BB b = other; b; b &= b - 1)
+    {
+        const int s = bit_first(b);
+        rest += BINOMIAL.c[s - bit_count(mover & ((BB(1) << s) - 1))][++k];
+    }
+    return own * BINOMIAL.c[32 - mover_count][k] + rest;
+}
+
+// Позиция по индексу (обратно к tb_index)
+inline void tb_unindex(uint64_t index, const int mover_count, const int other_count, BB &mover, BB &other)
+{
+    const uint32_t others = BINOMIAL.c[32 - mover_count][other_count];
+    uint32_t own = uint32_t(index / others), rest = uint32_t(index % others);
+    mover = other = 0;
+    int s = 31;
+    for (int k = mover_count; k > 0; --k)
+    {
+        while (BINOMIAL.c[s][k] > own)
+            --s;
+        own -= BINOMIAL.c[s][k];
+        mover |= BB(1) << s;
+    }
+    // Номера клеток соперника - среди свободных от своих дамок
+    BB free_squares = ~mover;
+    int free_index[32], free_count = 0;
+    for (BB b = free_squares; b; b &= b - 1)
+        free_index[free_count++] = bit_first(b);
+    s = free_count - 1;
+    for (int k = other_count; k > 0; --k)
+    {
+        while (BINOMIAL.c[s][k] > rest)
+            --s;
+        rest -= BINOMIAL.c[s][k];
+        other |= BB(1) << free_index[s];
+    }
+}
+
+// Значение таблицы: выигрыш/проигрыш стороны, делающей ход, и число ходов до конца партии
+inline bool tb_win(const uint8_t value)
+{
+    return value && ((value - 1) & 1);
+}
+
+inline bool tb_loss(const uint8_t value)
+{
+    return value && !((value - 1) & 1);
+}
+
+inline int tb_plies(const uint8_t value)
+{
+    return value - 1;
+}
+
+// Заголовок файла таблицы
+struct tb_header
+{
+    char magic[8];    // TB_MAGIC
+    uint8_t mover;    // Дамки стороны, делающей ход
+    uint8_t other;    // Дамки соперника
+    uint16_t version; // TB_VERSION
+    uint32_t count;   // Число позиций (байтов после заголовка)
+};
+static_assert(sizeof(tb_header) == 16, "tb_header is stored in the file as is");
+
+const char TB_MAGIC[8] = {'C', 'K', 'R', 'S', 'K', 'I', 'N', 'G'};
+const uint16_t TB_VERSION = 1;
+
+// Имя файла таблицы: kings_2_1.tb - две дамки у стороны, делающей ход, против одной
+inline string tb_file_name(const int mover, const int other)
+{
+    return "kings_" + to_string(mover) + "_" + to_string(other) + ".tb";
+}
+
+/**
+ * Набор таблиц, отображенных в память. Таблицы открываются все сразу из одной папки,
+ * отсутствующие таблицы просто не используются (позиции из них ищутся перебором)
+ */
+class Tablebase
+{
+  public:
+    // Открывает все таблицы из папки dir; false, если ни одной нет
+    bool open(const string &dir)
+    {
+        max_pieces = 0;
+        for (int mover = 1; mover < TB_MAX_PIECES; ++mover)
+        {
+            for (int other = 1; mover + other <= TB_MAX_PIECES; ++other)
+            {
+                tables[mover][other] = nullptr;
+                MappedFile &file = files[mover][other];
+                tb_header header;
+                if (!file.open(dir + tb_file_name(mover, other)) || file.size() < sizeof(header))
+                    continue;
+                memcpy(&header, file.data(), sizeof(header));
+                if (memcmp(header.magic, TB_MAGIC, sizeof(TB_MAGIC)) || header.version != TB_VERSION ||
+                    header.mover != mover || header.other != other || header.count != tb_size(mover, other) ||
+                    file.size() < sizeof(header) + header.count)
+                {
+                    file.close();
+                    continue;
+                }
+                tables[mover][other] = reinterpret_cast<const uint8_t *>(file.data() + sizeof(header));
+                max_pieces = max(max_pieces, mover + other);
+            }
+        }
+        return max_pieces > 0;
+    }
+
+    // Наибольшее число фигур среди открытых таблиц (0 - таблиц нет)
+    int pieces() const
+    {
+        return max_pieces;
+    }
+
+    /**
+     * Значение позиции pos, где ходит color (см. описание таблиц)
+     * @return false, если на доске есть шашки, фигур больше, чем в таблицах, или нужной таблицы нет
+     */
+    bool probe(const Position &pos, const bool color, uint8_t &value) const
+    {
+        if ((pos.white | pos.black) != pos.kings)
+            return false;
+        const BB mover = color ? pos.black : pos.white, other = color ? pos.white : pos.black;
+        const int mover_count = bit_count(mover), other_count = bit_count(other);
+        if (mover_count + other_count > max_pieces)
+            return false;
+        // У стороны без фигур нет ходов; соперник без фигур уже проиграл (ход за ним не наступит)
+        if (!mover_count)
+        {
+            value = 1;
+            return true;
+        }
+        if (!other_count)
+            return false;
+        const uint8_t *table = tables[mover_count][other_count];
+        if (!table)
+            return false;
+        value = table[tb_index(mover, other)];
+        return true;
+    }
+
+  private:
+    MappedFile files[TB_MAX_PIECES][TB_MAX_PIECES];              // [дамки стороны][дамки соперника]
+    const uint8_t *tables[TB_MAX_PIECES][TB_MAX_PIECES] = {};   // Значения позиций сразу после заголовка
+    int max_pieces = 0;
+};
@@ -0,0 +1,234 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "../Models/Move.h"
+
+using namespace std;
+
+// Тип оценки, сохраненной в таблице (оценки с точки зрения черных)
+enum tt_bound : uint8_t
+{
+    TT_EXACT, // Точное значение
+    TT_LOWER, // Значение не меньше сохраненного (отсечение по beta)
+    TT_UPPER  // Значение не больше сохраненного (отсечение по alpha)
+};
+
+// Запись таблицы транспозиций в распакованном виде
+struct tt_entry
+{
+    uint64_t key = 0;    // Полный хеш позиции (0 - пустая запись)
+    int score = 0;       // Оценка позиции (выигрыш - с расстоянием от этой позиции)
+    bit_move move;       // Лучший найденный ход
+    int8_t depth = -1;   // Оставшаяся глубина, на которой получена оценка
+    uint8_t bound = 0;   // Тип оценки (tt_bound)
+    uint8_t age = 0;     // Номер поиска, в котором сделана запись
+};
+
+// Статистика таблицы для подбора размера.
+// Счетчики ведет каждый поток поиска отдельно (без разделяемых атомиков), Logic их суммирует
+struct tt_stats
+{
+    uint64_t probes = 0;   // Обращений на чтение
+    uint64_t hits = 0;     // Найдено записей с совпавшим ключом
+    uint64_t stores = 0;   // Записей
+    uint64_t replaced = 0; // Записей, вытеснивших другую позицию
+    size_t entries = 0;    // Емкость таблицы в записях
+    int fill_permille = 0; // Заполненность текущим поиском (по выборке из первых 1000 корзин)
+
+    double hit_rate() const
+    {
+        return probes ? double(hits) / probes : 0;
+    }
+
+    void add(const tt_stats &other)
+    {
+        probes += other.probes;
+        hits += other.hits;
+        stores += other.stores;
+        replaced += other.replaced;
+    }
+};
+
+/**
+ * Таблица транспозиций фиксированного размера (степень двойки), общая для всех потоков поиска.
+ * Позиция попадает в корзину из двух записей по младшим битам хеша.
+ * Замещение: запись той же позиции обновляется; иначе вытесняется запись
+ * из прошлых поисков, а среди записей текущего поиска - менее глубокая.
+ * Таблица без блокировок: запись хранится в трех атомарных словах, первое из которых -
+ * ключ, сложенный по XOR с двумя другими. Запись, разорванная одновременной записью
+ * из другого потока, не проходит проверку ключа и считается промахом
+ */
+class TransTable
+{
+  public:
+    static const int BUCKET = 2;
+
+    // Размер задается в мегабайтах, 0 - таблица выключена
+    explicit TransTable(const size_t size_mb = 0)
+    {
+        resize(size_mb);
+    }
+
+    void resize(const size_t size_mb)
+    {
+        size_t buckets = 0;
+        if (size_mb)
+        {
+            buckets = 1;
+            while (buckets * 2 * BUCKET * sizeof(tt_slot) <= size_mb * 1024 * 1024)
+                buckets *= 2;
+        }
+        size = buckets * BUCKET;
+        table.reset(size ? new tt_slot[size] : nullptr);
+        mask = buckets ? buckets - 1 : 0;
+    }
+
+    bool enabled() const
+    {
+        return size != 0;
+    }
+
+    size_t entries() const
+    {
+        return size;
+    }
+
+    // Начало нового поиска: записи прошлых поисков становятся кандидатами на замещение
+    void new_search()
+    {
+        ++age;
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            table[i].check.store(0, memory_order_relaxed);
+            table[i].score.store(0, memory_order_relaxed);
+            table[i].data.store(0, memory_order_relaxed);
+        }
+    }
+
+    // Ищет запись позиции key, при успехе копирует ее в out
+    bool probe(const uint64_t key, tt_entry &out, tt_stats &stat) const
+    {
+        ++stat.probes;
+        const tt_slot *bucket = &table[(key & mask) * BUCKET];
+        for (int i = 0; i < BUCKET; ++i)
+        {
+            if (load(bucket[i], out) && out.key == key)
+            {
+                ++stat.hits;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void store(const uint64_t key, const int depth, const tt_bound bound, const int score, const bit_move &move,
+               tt_stats &stat)
+    {
+        ++stat.stores;
+        tt_slot *bucket = &table[(key & mask) * BUCKET];
+        tt_slot *slot = &bucket[0];
+        tt_entry current, chosen;
+        load(bucket[0], chosen);
+        for (int i = 0; i < BUCKET; ++i)
+        {
+            if (!load(bucket[i], current) || current.key == key)
+            {
+                slot = &bucket[i];
+                chosen = current;
+                break;
+            }
+            if (priority(current) < priority(chosen))
+            {
+                slot = &bucket[i];
+                chosen = current;
+            }
+        }
+        if (chosen.key && chosen.key != key)
+            ++stat.replaced;
+        // Более глубокую оценку той же позиции из текущего поиска не затираем мелкой границей
+        if (chosen.key == key && chosen.age == age && chosen.depth > depth && bound != TT_EXACT)
+            return;
+        tt_entry entry;
+        entry.key = key;
+        entry.score = score;
+        entry.move = move;
+        entry.depth = int8_t(depth);
+        entry.bound = bound;
+        entry.age = age;
+        save(*slot, entry);
+    }
+
+    // Заполненность записями текущего поиска в промилле (по выборке из первых 1000 корзин)
+    int fill_permille() const
+    {
+        const size_t sample = min(size, size_t(1000) * BUCKET);
+        size_t used = 0;
+        tt_entry entry;
+        for (size_t i = 0; i < sample; ++i)
+            used += load(table[i], entry) && entry.age == age;
+        return sample ? int(used * 1000 / sample) : 0;
+    }
+
+  private:
+    // Упакованная запись: score - оценка (32 бита), data - ход, глубина, тип оценки и возраст
+    struct tt_slot
+    {
+        atomic<uint64_t> check{0}; // key ^ score ^ data
+        atomic<uint64_t> score{0};
+        atomic<uint64_t> data{0};
+    };
+
+    // Распаковывает слот; false если слот пуст или поврежден одновременной записью
+    static bool load(const tt_slot &slot, tt_entry &entry)
+    {
+        const uint64_t data = slot.data.load(memory_order_relaxed);
+        const uint64_t score = slot.score.load(memory_order_relaxed);
+        const uint64_t check = slot.check.load(memory_order_relaxed);
+        if (!data)
+        {
+            entry = tt_entry();
+            return false;
+        }
+        entry.key = check ^ score ^ data;
+        entry.score = int32_t(uint32_t(score));
+        entry.move.from = uint8_t(data & 31);
+        entry.move.to = uint8_t((data >> 5) & 31);
+        entry.move.beaten = uint32_t(data >> 10);
+        entry.move.promote = (data >> 61) & 1;
+        entry.depth = int8_t(data >> 42);
+        entry.bound = uint8_t((data >> 50) & 3);
+        entry.age = uint8_t(data >> 52);
+        return true;
+    }
+
+    static void save(tt_slot &slot, const tt_entry &entry)
+    {
+        const uint64_t score = uint32_t(entry.score);
+        // Бит 60 гарантирует, что data занятого слота не равна нулю
+        const uint64_t data = uint64_t(entry.move.from) | (uint64_t(entry.move.to) << 5) |
+                              (uint64_t(entry.move.beaten) << 10) | (uint64_t(uint8_t(entry.depth)) << 42) |
+                              (uint64_t(entry.bound) << 50) | (uint64_t(entry.age) << 52) | (uint64_t(1) << 60) |
+                              (uint64_t(entry.move.promote) << 61);
+        slot.check.store(entry.key ^ score ^ data, memory_order_relaxed);
+        slot.score.store(score, memory_order_relaxed);
+        slot.data.store(data, memory_order_relaxed);
+    }
+
+    // Ценность записи при замещении: записи текущего поиска ценнее, среди них - более глубокие
+    int priority(const tt_entry &entry) const
+    {
+        return entry.depth + (entry.age == age ? 256 : 0);
+    }
+
+    unique_ptr<tt_slot[]> table;
+    size_t size = 0;
+    size_t mask = 0;
+    uint8_t age = 0;
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include <stdlib.h>
+#include <cstdint>
 
 // Тип для координат на игровом поле. 
 // Использование int8_t оптимизирует память для полей стандартных размеров (до 128x128)
@@ -37,3 +38,73 @@ struct move_pos
         return !(*this == other);
     }
 };
+
+// Компактный ход на битовой доске (см. Game/Position.h), используется в переборе бота.
+// Серия взятий хранится целиком: начальная и конечная клетки и маска всех побитых фигур
+struct bit_move
+{
+    uint8_t from = 0, to = 0; // Индексы начальной и конечной игровой клетки (0..31)
+    uint32_t beaten = 0;      // Маска побитых фигур. 0 - ход без взятия
+    bool promote = false;     // Шашка становится дамкой (в том числе посреди серии взятий)
+
+    bit_move() = default;
+    bit_move(const int from, const int to, const uint32_t beaten = 0, const bool promote = false)
+        : from(uint8_t(from)), to(uint8_t(to)), beaten(beaten), promote(promote)
+    {
+    }
+
+    bool operator==(const bit_move &other) const
+    {
+        return from == other.from && to == other.to && beaten == other.beaten && promote == other.promote;
+    }
+    bool operator!=(const bit_move &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+// Список ходов фиксированной емкости: генерация ходов в переборе не выделяет память в куче
+struct move_list
+{
+    static const int MAX_SIZE = 256; // С запасом больше максимально возможного числа ходов в позиции
+
+    bit_move moves[MAX_SIZE];
+    int size = 0;
+
+    void clear()
+    {
+        size = 0;
+    }
+    bool empty() const
+    {
+        return size == 0;
+    }
+    void emplace_back(const int from, const int to, const uint32_t beaten = 0, const bool promote = false)
+    {
+        moves[size++] = bit_move(from, to, beaten, promote);
+    }
+    bit_move &operator[](const int i)
+    {
+        return moves[i];
+    }
+    const bit_move &operator[](const int i) const
+    {
+        return moves[i];
+    }
+    bit_move *begin()
+    {
+        return moves;
+    }
+    bit_move *end()
+    {
+        return moves + size;
+    }
+    const bit_move *begin() const
+    {
+        return moves;
+    }
+    const bit_move *end() const
+    {
+        return moves + size;
+    }
+};
@@ -0,0 +1,467 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#include "../Game/Logic.h"
+#include "../Game/Match.h"
+
+// Счетчик выделений памяти в куче: показывает, что узлы перебора не аллоцируют.
+// Атомарный, так как bench threads и bench o2 выделяют память из нескольких потоков
+static atomic<uint64_t> heap_allocations{0};
+
+// Все формы new и delete заменяются парами, чтобы выделение и освобождение шли через malloc/free
+static void *counted_alloc(const size_t size)
+{
+    heap_allocations.fetch_add(1, memory_order_relaxed);
+    if (void *ptr = malloc(size ? size : 1))
+        return ptr;
+    throw bad_alloc();
+}
+
+void *operator new(size_t size)
+{
+    return counted_alloc(size);
+}
+
+void *operator new[](size_t size)
+{
+    return counted_alloc(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+// Обход дерева ходов на глубину depth
+void bench_perft(Logic &logic, const int depth)
+{
+    const uint64_t allocations_before = heap_allocations;
+    auto start = chrono::steady_clock::now();
+    const uint64_t nodes = logic.perft(Position::start(), 0, depth);
+    auto end = chrono::steady_clock::now();
+    const uint64_t allocations = heap_allocations - allocations_before;
+
+    const double ms = chrono::duration<double, milli>(end - start).count();
+    cout << "perft depth:       " << depth << "\n";
+    cout << "nodes:             " << nodes << "\n";
+    cout << "time ms:           " << int(ms) << "\n";
+    cout << "nodes/sec:         " << uint64_t(nodes / max(ms, 1.0) * 1000) << "\n";
+    cout << "heap allocations:  " << allocations << "\n";
+}
+
+// Поиск лучшего хода из начальной позиции на уровне level (глубина level + 1)
+void bench_search(Logic &logic, const int level)
+{
+    logic.Max_depth = level;
+    const uint64_t allocations_before = heap_allocations;
+    auto start = chrono::steady_clock::now();
+    logic.find_best_turns(Position::start(), 0);
+    auto end = chrono::steady_clock::now();
+    const uint64_t allocations = heap_allocations - allocations_before;
+
+    const double ms = chrono::duration<double, milli>(end - start).count();
+    cout << "search level:      " << level << "\n";
+    cout << "reached depth:     " << logic.reached_depth << " (selective " << logic.last_search.seldepth << ")\n";
+    cout << "nodes:             " << logic.nodes << "\n";
+    cout << "quiescence nodes:  " << logic.qnodes << "\n";
+    cout << "time ms:           " << int(ms) << "\n";
+    cout << "nodes/sec:         " << uint64_t(logic.nodes / max(ms, 1.0) * 1000) << "\n";
+    cout << "heap allocations:  " << allocations << " (root move list and search stats only)\n";
+    const order_stats order = logic.ordering_stats();
+    cout << "first move cutoff: " << order.first_move_rate() << " (" << order.first_move_cutoffs << " of "
+         << order.cutoffs << ")\n";
+    const tt_stats tt = logic.table_stats();
+    cout << "tt entries:        " << tt.entries << "\n";
+    cout << "tt hit rate:       " << tt.hit_rate() << " (" << tt.hits << " of " << tt.probes << " probes)\n";
+    cout << "tt stores:         " << tt.stores << ", replaced " << tt.replaced << "\n";
+    cout << "tt fill permille:  " << tt.fill_permille << "\n";
+    cout << "pv:                " << logic.last_search.pv_string() << "\n";
+}
+
+// Масштабирование по числу потоков: время до глубины и nodes/sec для 1, 2, 4... потоков
+void bench_threads(Logic &logic, const int level, const int max_threads)
+{
+    logic.Max_depth = level;
+    cout << "threads  depth  time ms  nodes      nodes/sec   speedup\n";
+    double base_ms = 0;
+    for (int count = 1;; count = min(count * 2, max_threads))
+    {
+        logic.set_threads(count);
+        logic.tt.clear();
+        auto start = chrono::steady_clock::now();
+        logic.find_best_turns(Position::start(), 0);
+        auto end = chrono::steady_clock::now();
+        const double ms = max(chrono::duration<double, milli>(end - start).count(), 1.0);
+        if (count == 1)
+            base_ms = ms;
+        cout << count << "\t " << logic.reached_depth << "\t" << int(ms) << "\t  " << logic.nodes << "\t "
+             << uint64_t(logic.nodes / ms * 1000) << "\t " << base_ms / ms << "\n";
+        if (count == max_threads)
+            break;
+    }
+}
+
+// Оценка полным просмотром доски, как до инкрементальных счетчиков (эталон для bench eval)
+int reference_score(const Position &pos, const bool potential)
+{
+    const BB w_men = pos.white & ~pos.kings, b_men = pos.black & ~pos.kings;
+    // Материал в двадцатых долях шашки: бонус за строку продвижения - 1
+    int w = 20 * bit_count(w_men), b = 20 * bit_count(b_men);
+    const int wq = bit_count(pos.white & pos.kings), bq = bit_count(pos.black & pos.kings);
+    if (potential)
+    {
+        for (int row = 0; row < 8; ++row)
+        {
+            const BB mask = TOP_ROW << (4 * row);
+            w += bit_count(w_men & mask) * (7 - row);
+            b += bit_count(b_men & mask) * row;
+        }
+    }
+    const int q_coef = potential ? 5 : 4;
+    w += 20 * wq * q_coef;
+    b += 20 * bq * q_coef;
+    if (w == 0)
+        return MATE;
+    if (b == 0)
+        return -MATE;
+    return EVAL_SCALE * (b - w) / (b + w);
+}
+
+/**
+ * Сверка инкрементальной оценки с полным пересчетом: случайные партии, в каждой позиции
+ * выполняется и откатывается каждый ход. Оценки должны совпасть точно (побитно),
+ * счетчики позиции - с пересчитанными с нуля
+ */
+void bench_eval(const Config &config, const int games)
+{
+    mt19937 rng(10);
+    uint64_t checked = 0, mismatches = 0;
+    for (const bool potential : {false, true})
+    {
+        Config mode = config;
+        mode.set("Bot", "BotScoringType", potential ? "NumberAndPotential" : "NumberOnly");
+        Logic logic(&mode);
+        auto check = [&](const Position &pos) {
+            const Position fresh(pos.to_mtx());
+            const bool same_counts = !memcmp(&fresh.material, &pos.material, sizeof(material_counts));
+            mismatches += !same_counts || logic.evaluate(pos) != reference_score(pos, potential);
+            ++checked;
+        };
+        for (int game = 0; game < games; ++game)
+        {
+            Position pos = Position::start();
+            bool color = 0;
+            move_list moves;
+            Position::undo_info undo;
+            for (int ply = 0; ply < 200; ++ply, color = !color)
+            {
+                pos.gen_moves(color, moves);
+                if (moves.empty())
+                    break;
+                for (const auto &turn : moves)
+                {
+                    pos.do_move(turn, undo);
+                    check(pos);
+                    pos.undo_move(turn, undo);
+                    check(pos);
+                }
+                pos.do_move(moves[rng() % moves.size], undo);
+            }
+        }
+    }
+    cout << "eval positions:    " << checked << "\n";
+    cout << "mismatches:        " << mismatches << "\n";
+}
+
+// Набор дебютов для сравнительных матчей: позиции после 4-6 случайных ходов (фиксированный seed)
+vector<pair<Position, bool>> make_openings(const int count)
+{
+    mt19937 rng(2024);
+    vector<pair<Position, bool>> openings;
+    for (int i = 0; i < count; ++i)
+    {
+        bool color;
+        Position pos = random_opening(rng, 4 + i % 3, color);
+        openings.emplace_back(pos, color);
+    }
+    return openings;
+}
+
+// Бот для сравнения уровней оптимизации: настройки settings.json с заменой уровня и бюджета
+unique_ptr<Logic> make_bot(const Config &base, const string &optimization, const int level, const int time_ms,
+                           const int quiescence_depth)
+{
+    Config config = base;
+    config.set("Bot", "Optimization", optimization);
+    config.set("Bot", "TimeBudgetMS", time_ms);
+    config.set("Bot", "QuiescenceDepth", quiescence_depth);
+    auto bot = make_unique<Logic>(&config);
+    bot->Max_depth = level;
+    return bot;
+}
+
+// Итог серии партий первого бота против второго
+struct pairs_result
+{
+    int wins = 0, draws = 0, losses = 0;
+    double move_ms[2] = {0, 0}; // Среднее время хода первого и второго бота
+};
+
+// Каждый дебют играется дважды со сменой цветов
+pairs_result play_pairs(Logic &first, Logic &second, const vector<pair<Position, bool>> &openings, const int games,
+                        const int max_turns)
+{
+    pairs_result res;
+    double total_ms[2] = {0, 0};
+    int moves[2] = {0, 0};
+    for (int i = 0; i < games; ++i)
+    {
+        for (int first_color = 0; first_color < 2; ++first_color)
+        {
+            Match match(first_color ? &second : &first, first_color ? &first : &second, max_turns);
+            const match_result game = match.play(openings[i].first, openings[i].second);
+            if (game.winner == -1)
+                ++res.draws;
+            else if (game.winner == first_color)
+                ++res.wins;
+            else
+                ++res.losses;
+            for (int color = 0; color < 2; ++color)
+            {
+                const int bot = color != first_color;
+                for (const auto &move : game.moves[color])
+                    total_ms[bot] += move.ms;
+                moves[bot] += int(game.moves[color].size());
+            }
+        }
+    }
+    for (int bot = 0; bot < 2; ++bot)
+        res.move_ms[bot] = moves[bot] ? total_ms[bot] / moves[bot] : 0;
+    return res;
+}
+
+void print_pairs(const string &title, const pairs_result &res)
+{
+    double error;
+    const double elo = elo_difference(res.wins, res.draws, res.losses, error);
+    cout << title << ": +" << res.wins << " =" << res.draws << " -" << res.losses << ", elo " << elo << " +- "
+         << error << ", ms/move " << res.move_ms[0] << " vs " << res.move_ms[1] << "\n";
+}
+
+/**
+ * Регрессия "O2" против "O1":
+ * 1) ускорение - время и узлы до фиксированного уровня level на наборе дебютных позиций
+ *    и доля позиций, где O2 выбрал тот же ход;
+ * 2) сила - games пар партий с равным бюджетом времени time_ms на ход
+ *    (каждый дебют играется дважды со сменой цветов), итог в очках и разнице Эло
+ */
+void bench_o2(const Config &config, const int level, const int games, const int time_ms)
+{
+    const int quiescence_depth = config("Bot", "QuiescenceDepth");
+    const auto openings = make_openings(max(games, 16));
+    auto o1 = make_bot(config, "O1", level, 0, quiescence_depth);
+    auto o2 = make_bot(config, "O2", level, 0, quiescence_depth);
+    double ms[2] = {0, 0};
+    uint64_t nodes[2] = {0, 0};
+    int same = 0;
+    for (const auto &opening : openings)
+    {
+        vector<move_pos> best[2];
+        Logic *bots[2] = {o1.get(), o2.get()};
+        for (int k = 0; k < 2; ++k)
+        {
+            bots[k]->tt.clear();
+            auto start = chrono::steady_clock::now();
+            best[k] = bots[k]->find_best_turns(opening.first, opening.second);
+            ms[k] += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            nodes[k] += bots[k]->nodes;
+        }
+        same += best[0] == best[1];
+    }
+    cout << "fixed level " << level << " on " << openings.size() << " positions\n";
+    cout << "O1 time ms / nodes: " << int(ms[0]) << " / " << nodes[0] << "\n";
+    cout << "O2 time ms / nodes: " << int(ms[1]) << " / " << nodes[1] << "\n";
+    cout << "speedup:            " << ms[0] / max(ms[1], 1.0) << "x time, " << double(nodes[0]) / max<uint64_t>(nodes[1], 1)
+         << "x nodes\n";
+    cout << "same move:          " << same << " of " << openings.size() << "\n";
+
+    o1 = make_bot(config, "O1", 30, time_ms, quiescence_depth);
+    o2 = make_bot(config, "O2", 30, time_ms, quiescence_depth);
+    print_pairs("O2 vs O1 at " + to_string(time_ms) + " ms/move",
+                play_pairs(*o2, *o1, openings, games, config("Game", "MaxNumTurns")));
+}
+
+/**
+ * Специализированный перебор (политики выбраны при старте) против проверки режимов в каждом узле:
+ * поиск уровня level на фиксированных позициях (начальная и дебюты), лучшее время из трех запусков.
+ * Деревья перебора одинаковы, поэтому совпадают и узлы, и выбранные ходы
+ */
+void bench_dispatch(const Config &config, const int level)
+{
+    auto openings = make_openings(15);
+    openings.emplace(openings.begin(), Position::start(), false);
+    Config fixed = config;
+    fixed.set("Bot", "NoRandom", true);
+    Logic logic(&fixed);
+    logic.Max_depth = level;
+    double ms[2] = {0, 0};
+    uint64_t nodes[2] = {0, 0};
+    int same = 0;
+    for (const auto &opening : openings)
+    {
+        vector<move_pos> best[2];
+        for (int runtime = 0; runtime < 2; ++runtime)
+        {
+            logic.runtime_dispatch = runtime;
+            double best_ms = 1e18;
+            for (int run = 0; run < 3; ++run)
+            {
+                logic.new_game();
+                auto start = chrono::steady_clock::now();
+                best[runtime] = logic.find_best_turns(opening.first, opening.second);
+                best_ms = min(best_ms, chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+            }
+            ms[runtime] += best_ms;
+            nodes[runtime] += logic.nodes;
+        }
+        same += best[0] == best[1];
+    }
+    const string scoring = config("Bot", "BotScoringType"), optimization = config("Bot", "Optimization");
+    cout << scoring << " " << optimization << ", level " << level << " on " << openings.size() << " positions\n";
+    cout << "specialized ms:    " << int(ms[0]) << " (" << uint64_t(nodes[0] / max(ms[0], 1.0) * 1000) << " nodes/sec)\n";
+    cout << "runtime ms:        " << int(ms[1]) << " (" << uint64_t(nodes[1] / max(ms[1], 1.0) * 1000) << " nodes/sec)\n";
+    cout << "speedup:           " << ms[1] / max(ms[0], 1e-3) << "\n";
+    cout << "same nodes / move: " << (nodes[0] == nodes[1] ? "yes" : "no") << " / " << same << " of "
+         << openings.size() << "\n";
+}
+
+/**
+ * Продление взятий: бот уровня level с продлением против бота уровня level + 2 без него
+ * (та же оптимизация из settings.json). Показывает силу и среднее время хода обоих
+ */
+void bench_quiescence(const Config &config, const int level, const int games)
+{
+    const string optimization = config("Bot", "Optimization");
+    const auto openings = make_openings(games);
+    auto with_qs = make_bot(config, optimization, level, 0, config("Bot", "QuiescenceDepth"));
+    auto deeper = make_bot(config, optimization, level + 2, 0, 0);
+    print_pairs("level " + to_string(level) + " with quiescence vs level " + to_string(level + 2) + " without",
+                play_pairs(*with_qs, *deeper, openings, games, config("Game", "MaxNumTurns")));
+}
+
+// Позиции миттельшпиля: дебют из 4-6 случайных ходов, затем 14 ходов партии ботов уровня 2 (фиксированный seed)
+vector<pair<Position, bool>> make_middlegames(const Config &base, const int count)
+{
+    Config config = base;
+    config.set("Bot", "NoRandom", true);
+    config.set("Bot", "OpeningBook", "");
+    config.set("Bot", "Threads", 1);
+    Logic bot(&config);
+    bot.Max_depth = 2;
+    vector<pair<Position, bool>> positions;
+    for (const auto &opening : make_openings(count))
+    {
+        Position pos = opening.first;
+        bool color = opening.second;
+        Position::undo_info undo;
+        for (int ply = 0; ply < 14; ++ply, color = !color)
+        {
+            const vector<move_pos> steps = bot.find_best_turns(pos, color);
+            if (steps.empty())
+                break;
+            for (const auto &step : steps)
+                pos.do_move(to_bit_move(step), undo);
+        }
+        positions.emplace_back(pos, color);
+    }
+    return positions;
+}
+
+/**
+ * Окна вокруг оценки прошлой итерации (AspirationWindows) против полного окна: время и узлы до уровня level
+ * на positions позициях миттельшпиля, каждая со свежей таблицей транспозиций. Оценки и ходы должны совпасть
+ */
+void bench_aspiration(const Config &config, const int level, const int positions)
+{
+    const auto middlegames = make_middlegames(config, positions);
+    double ms[2] = {0, 0};
+    uint64_t nodes[2] = {0, 0};
+    int same_move = 0, same_score = 0, researches = 0;
+    for (const auto &position : middlegames)
+    {
+        vector<move_pos> best[2];
+        int score[2];
+        for (int aspiration = 0; aspiration < 2; ++aspiration)
+        {
+            Config mode = config;
+            mode.set("Bot", "NoRandom", true);
+            mode.set("Bot", "OpeningBook", "");
+            mode.set("Bot", "Threads", 1);
+            mode.set("Bot", "TimeBudgetMS", 0);
+            mode.set("Bot", "AspirationWindows", bool(aspiration));
+            Logic logic(&mode);
+            logic.Max_depth = level;
+            auto start = chrono::steady_clock::now();
+            best[aspiration] = logic.find_best_turns(position.first, position.second);
+            ms[aspiration] += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            nodes[aspiration] += logic.nodes;
+            score[aspiration] = logic.last_search.score;
+            if (aspiration)
+                researches += logic.researches;
+        }
+        same_move += best[0] == best[1];
+        same_score += score[0] == score[1];
+    }
+    const string optimization = config("Bot", "Optimization");
+    cout << optimization << ", level " << level << " on " << middlegames.size() << " middlegame positions\n";
+    cout << "full window ms / nodes: " << int(ms[0]) << " / " << nodes[0] << "\n";
+    cout << "aspiration ms / nodes:  " << int(ms[1]) << " / " << nodes[1] << " (" << researches << " re-searches)\n";
+    cout << "speedup:                " << ms[0] / max(ms[1], 1.0) << "x time, "
+         << double(nodes[0]) / max<uint64_t>(nodes[1], 1) << "x nodes\n";
+    cout << "same score / move:      " << same_score << " / " << same_move << " of " << middlegames.size() << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+    const string mode = argc > 1 ? argv[1] : "all";
+    const int depth = argc > 2 ? atoi(argv[2]) : 8;
+    Config config;
+    Logic logic(&config);
+
+    if (mode == "perft" || mode == "all")
+        bench_perft(logic, depth);
+    if (mode == "search" || mode == "all")
+        bench_search(logic, depth);
+    if (mode == "threads")
+        bench_threads(logic, depth, argc > 3 ? atoi(argv[3]) : max(1, int(thread::hardware_concurrency())));
+    if (mode == "dispatch")
+        bench_dispatch(config, depth);
+    if (mode == "eval")
+        bench_eval(config, argc > 2 ? depth : 1000);
+    if (mode == "quiescence")
+        bench_quiescence(config, depth, argc > 3 ? atoi(argv[3]) : 20);
+    if (mode == "aspiration")
+        bench_aspiration(config, depth, argc > 3 ? atoi(argv[3]) : 20);
+    if (mode == "o2")
+        bench_o2(config, depth, argc > 3 ? atoi(argv[3]) : 20, argc > 4 ? atoi(argv[4]) : 100);
+    return 0;
+}
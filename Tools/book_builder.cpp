@@ -0,0 +1,221 @@
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+#include "../Game/Logic.h"
+#include "../Game/OpeningBook.h"
+#include "bot_config.h"
+
+// Параметры построения книги
+struct book_options
+{
+    string config_path = project_path + "settings.json"; // Настройки бота, которым ищутся ходы
+    vector<string> overrides;  // Переопределения "Раздел.Параметр=значение"
+    string out = project_path + "opening_book.bin"; // Файл книги
+    int level = 10;            // Уровень поиска ответов (глубина level + 1)
+    int plies = 6;             // Книга покрывает позиции первых plies ходов
+    int margin = 25;           // Ход в книге, если его оценка хуже лучшей не больше чем на столько
+    int jobs = max(1, int(thread::hardware_concurrency())); // Позиций одновременно (по умолчанию - все ядра)
+};
+
+void print_usage()
+{
+    cerr << "usage: book_builder [options]\n"
+            "  --config PATH    bot settings (default settings.json)\n"
+            "  --set KEY=VALUE  override a setting, KEY is Section.Name, e.g. Bot.Optimization=O2 (can be repeated)\n"
+            "  --level N        search level for every book move (depth N + 2, default 10)\n"
+            "  --plies N        book covers the first N plies (default 6)\n"
+            "  --margin N       keep moves scored within N points of the best one (default 25, a man is worth\n"
+            "                   about 400 points in the opening)\n"
+            "  --jobs N         positions searched in parallel (default all cores)\n"
+            "  --out PATH       book file (default opening_book.bin)\n";
+}
+
+bool parse_options(const int argc, char *argv[], book_options &opt)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+            return false;
+        if (i + 1 >= argc)
+        {
+            cerr << "missing value for " << arg << "\n";
+            return false;
+        }
+        const string value = argv[++i];
+        if (arg == "--config")
+            opt.config_path = value;
+        else if (arg == "--set")
+            opt.overrides.push_back(value);
+        else if (arg == "--level")
+            opt.level = max(0, atoi(value.c_str()));
+        else if (arg == "--plies")
+            opt.plies = max(1, atoi(value.c_str()));
+        else if (arg == "--margin")
+            opt.margin = max(0, atoi(value.c_str()));
+        else if (arg == "--jobs")
+            opt.jobs = max(1, atoi(value.c_str()));
+        else if (arg == "--out")
+            opt.out = value;
+        else
+        {
+            cerr << "unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Позиция дерева дебютов
+struct book_node
+{
+    Position pos;
+    uint8_t sides = 0;         // Для какого цвета бота позиция достижима: бит 0 - белые, бит 1 - черные
+    vector<bit_move> moves;    // Ходы книги (если ходит бот)
+    vector<uint16_t> weights;  // Их веса
+};
+
+/**
+ * Ходы книги для позиции: каждый ход оценивается отдельным поиском ответа соперника,
+ * в книгу попадают ходы не хуже лучшего больше чем на margin. Оценка - с точки зрения
+ * ходящей стороны, вес хода - 1000 минус отставание от лучшей оценки (1000 - лучший ход)
+ */
+void book_moves(Logic &bot, book_node &node, const bool color, const int margin)
+{
+    move_list moves;
+    node.pos.gen_moves(color, moves);
+    vector<int> gains;
+    int best = -INF;
+    for (const auto &turn : moves)
+    {
+        Position child = node.pos;
+        Position::undo_info undo;
+        child.do_move(turn, undo);
+        int score = color ? MATE : -MATE; // У соперника нет ходов - он проиграл
+        if (!bot.find_best_turns(child, !color).empty())
+            score = bot.last_search.score;
+        const int gain = color ? score : -score;
+        gains.push_back(gain);
+        best = max(best, gain);
+    }
+    for (int i = 0; i < moves.size; ++i)
+    {
+        if (gains[i] < best - margin)
+            continue;
+        node.moves.push_back(moves[i]);
+        node.weights.push_back(uint16_t(max(1, 1000 - (best - gains[i]))));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    book_options opt;
+    if (!parse_options(argc, argv, opt))
+    {
+        print_usage();
+        return 1;
+    }
+    unique_ptr<Config> config;
+    if (!load_bot_config(opt.config_path, opt.overrides, config))
+        return 1;
+    // Старая книга не подсказывает ходы, а поиск идет на полную глубину без ограничения времени
+    config->set("Bot", "OpeningBook", "");
+    config->set("Bot", "TimeBudgetMS", 0);
+    config->set("Bot", "NoRandom", true);
+    config->set("Bot", "Threads", 1);
+
+    // Обход дерева дебютов по ходам: за бота - только ходы книги, за соперника - все ходы.
+    // Позиции, достижимые разными путями, объединяются
+    vector<book_node> level{book_node()};
+    level[0].pos = Position::start();
+    level[0].sides = 3;
+    vector<book_entry> entries;
+    for (int ply = 0; ply < opt.plies && !level.empty(); ++ply)
+    {
+        const bool color = ply & 1;
+        atomic<size_t> next(0);
+        atomic<int> done(0);
+        int to_search = 0;
+        for (const auto &node : level)
+            to_search += (node.sides >> color) & 1;
+        auto worker = [&]() {
+            Logic bot(config.get());
+            bot.Max_depth = opt.level;
+            for (size_t i; (i = next++) < level.size();)
+            {
+                if (!((level[i].sides >> color) & 1))
+                    continue;
+                book_moves(bot, level[i], color, opt.margin);
+                const int count = ++done;
+                if (count % 100 == 0)
+                    cerr << "  " << count << "/" << to_search << "\n";
+            }
+        };
+        vector<thread> workers;
+        for (int i = 1; i < opt.jobs; ++i)
+            workers.emplace_back(worker);
+        worker();
+        for (auto &w : workers)
+            w.join();
+
+        vector<book_node> next_level;
+        unordered_map<uint64_t, size_t> index;
+        move_list moves;
+        Position::undo_info undo;
+        for (auto &node : level)
+        {
+            for (size_t i = 0; i < node.moves.size(); ++i)
+                entries.push_back({node.pos.key(color), node.moves[i].beaten, node.moves[i].from, node.moves[i].to,
+                                   node.weights[i]});
+            node.pos.gen_moves(color, moves);
+            for (const auto &turn : moves)
+            {
+                const bool in_book = find(node.moves.begin(), node.moves.end(), turn) != node.moves.end();
+                // Сторона бота продолжает только ходами книги, сторона соперника - любыми
+                const uint8_t sides = node.sides & (in_book ? 3 : ~(1 << color));
+                if (!sides)
+                    continue;
+                Position child = node.pos;
+                child.do_move(turn, undo);
+                auto it = index.emplace(child.key(!color), next_level.size());
+                if (it.second)
+                {
+                    next_level.emplace_back();
+                    next_level.back().pos = child;
+                }
+                next_level[it.first->second].sides |= sides;
+            }
+        }
+        cerr << "ply " << ply + 1 << ": " << to_search << " positions searched, " << entries.size()
+             << " book moves\n";
+        level.swap(next_level);
+    }
+
+    // Записи сортируются по ключу, ходы одной позиции - по убыванию веса (первый - ход для NoRandom)
+    sort(entries.begin(), entries.end(), [](const book_entry &a, const book_entry &b) {
+        if (a.key != b.key)
+            return a.key < b.key;
+        if (a.weight != b.weight)
+            return a.weight > b.weight;
+        return a.from != b.from ? a.from < b.from : a.to < b.to;
+    });
+    book_header header;
+    memcpy(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+    header.version = BOOK_VERSION;
+    header.level = uint16_t(opt.level);
+    header.count = uint32_t(entries.size());
+    ofstream fout(opt.out, ios::binary);
+    fout.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    fout.write(reinterpret_cast<const char *>(entries.data()), streamsize(entries.size() * sizeof(book_entry)));
+    if (!fout)
+    {
+        cerr << "cannot write " << opt.out << "\n";
+        return 1;
+    }
+    cout << entries.size() << " book moves written to " << opt.out << "\n";
+    return 0;
+}
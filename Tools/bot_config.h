@@ -0,0 +1,38 @@
+#pragma once
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../Game/Config.h"
+
+/**
+ * Загружает настройки бота для консольных утилит и применяет переопределения "Раздел.Параметр=значение"
+ * из командной строки. Значение разбирается как JSON (числа, true/false), иначе считается строкой
+ * @return false (с сообщением в stderr), если файл не открылся или переопределение записано неверно
+ */
+inline bool load_bot_config(const string &path, const vector<string> &overrides, unique_ptr<Config> &config)
+{
+    if (!ifstream(path))
+    {
+        cerr << "cannot open " << path << "\n";
+        return false;
+    }
+    config.reset(new Config(path));
+    for (const auto &item : overrides)
+    {
+        const size_t dot = item.find('.'), eq = item.find('=');
+        if (dot == string::npos || eq == string::npos || dot > eq)
+        {
+            cerr << "bad override " << item << ", expected Section.Name=value\n";
+            return false;
+        }
+        const string value = item.substr(eq + 1);
+        json parsed = json::parse(value, nullptr, false);
+        if (parsed.is_discarded())
+            parsed = value;
+        config->set(item.substr(0, dot), item.substr(dot + 1, eq - dot - 1), parsed);
+    }
+    return true;
+}
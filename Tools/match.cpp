@@ -0,0 +1,200 @@
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "../Game/Match.h"
+#include "bot_config.h"
+
+// Параметры запуска checkers_match
+struct match_options
+{
+    string config_path[2] = {project_path + "settings.json", project_path + "settings.json"}; // Настройки ботов A и B
+    vector<string> overrides[2]; // Переопределения "Раздел.Параметр=значение"
+    int level[2] = {-1, -1};     // Уровень ботов (-1 - BlackBotLevel из их настроек)
+    int games = 100;             // Число партий (парами со сменой цветов)
+    int plies = 4;               // Длина случайного дебюта
+    unsigned seed = 1;           // Seed генератора дебютов
+    int jobs = 1;                // Число партий, играемых одновременно
+    int max_turns = -1;          // Предел ходов до ничьей (-1 - MaxNumTurns из настроек бота A)
+    string out_path;             // Файл результатов (пусто - stdout)
+};
+
+void print_usage()
+{
+    cerr << "usage: checkers_match [options]\n"
+            "  --a PATH, --b PATH        settings of bot A / bot B (default settings.json)\n"
+            "  --set-a KEY=VALUE         override a setting of bot A, KEY is Section.Name, e.g. Bot.Optimization=O2\n"
+            "  --set-b KEY=VALUE         the same for bot B (both can be repeated)\n"
+            "  --level-a N, --level-b N  bot level (default Bot.BlackBotLevel of its settings)\n"
+            "  --games N                 number of games, each opening is played with both colors (default 100)\n"
+            "  --plies N                 random opening length in plies (default 4)\n"
+            "  --seed N                  seed of the openings (default 1)\n"
+            "  --jobs N                  games played in parallel (default 1)\n"
+            "  --max-turns N             turns before a draw (default Game.MaxNumTurns of bot A)\n"
+            "  --out PATH                write results to a file instead of stdout\n";
+}
+
+bool parse_options(const int argc, char *argv[], match_options &opt)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+            return false;
+        if (i + 1 >= argc)
+        {
+            cerr << "missing value for " << arg << "\n";
+            return false;
+        }
+        const string value = argv[++i];
+        if (arg == "--a" || arg == "--b")
+            opt.config_path[arg == "--b"] = value;
+        else if (arg == "--set-a" || arg == "--set-b")
+            opt.overrides[arg == "--set-b"].push_back(value);
+        else if (arg == "--level-a" || arg == "--level-b")
+            opt.level[arg == "--level-b"] = atoi(value.c_str());
+        else if (arg == "--games")
+            opt.games = atoi(value.c_str());
+        else if (arg == "--plies")
+            opt.plies = atoi(value.c_str());
+        else if (arg == "--seed")
+            opt.seed = unsigned(atoi(value.c_str()));
+        else if (arg == "--jobs")
+            opt.jobs = max(1, atoi(value.c_str()));
+        else if (arg == "--max-turns")
+            opt.max_turns = atoi(value.c_str());
+        else if (arg == "--out")
+            opt.out_path = value;
+        else
+        {
+            cerr << "unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Партия в формате JSON: исход с точки зрения ботов A и B и статистика каждого хода по порядку
+json game_to_json(const int game, const bool a_color, const bool first_color, const match_result &res)
+{
+    json moves = json::array();
+    size_t index[2] = {0, 0};
+    for (int k = 0; k < res.turns; ++k)
+    {
+        const bool color = first_color ^ (k & 1);
+        const move_record &move = res.moves[color][index[color]++];
+        moves.push_back({{"side", color == a_color ? "a" : "b"}, {"ms", move.ms}, {"nodes", move.nodes},
+                         {"depth", move.depth}});
+    }
+    const string result = res.winner == -1 ? "draw" : (res.winner == a_color ? "a" : "b");
+    return {{"game", game}, {"a_color", a_color ? "black" : "white"}, {"result", result}, {"turns", res.turns},
+            {"repetition", res.repetition}, {"moves", moves}};
+}
+
+int main(int argc, char *argv[])
+{
+    match_options opt;
+    if (!parse_options(argc, argv, opt))
+    {
+        print_usage();
+        return 1;
+    }
+    unique_ptr<Config> configs[2];
+    for (int bot = 0; bot < 2; ++bot)
+    {
+        if (!load_bot_config(opt.config_path[bot], opt.overrides[bot], configs[bot]))
+            return 1;
+        if (opt.level[bot] == -1)
+            opt.level[bot] = (*configs[bot])("Bot", "BlackBotLevel");
+    }
+    if (opt.max_turns == -1)
+        opt.max_turns = (*configs[0])("Game", "MaxNumTurns");
+
+    ofstream fout;
+    if (!opt.out_path.empty())
+    {
+        fout.open(opt.out_path);
+        if (!fout)
+        {
+            cerr << "cannot write " << opt.out_path << "\n";
+            return 1;
+        }
+    }
+    ostream &out = opt.out_path.empty() ? cout : fout;
+
+    // Каждый дебют играется дважды: бот A белыми в четной партии и черными в нечетной
+    mt19937 rng(opt.seed);
+    vector<pair<Position, bool>> openings;
+    for (int i = 0; i < (opt.games + 1) / 2; ++i)
+    {
+        bool color;
+        const Position pos = random_opening(rng, opt.plies, color);
+        openings.emplace_back(pos, color);
+    }
+
+    atomic<int> next(0);
+    mutex out_mtx;
+    int wins = 0, draws = 0, losses = 0;
+    double total_ms[2] = {0, 0};
+    uint64_t moves[2] = {0, 0};
+    auto worker = [&]() {
+        Logic bots[2] = {Logic(configs[0].get()), Logic(configs[1].get())};
+        for (int bot = 0; bot < 2; ++bot)
+            bots[bot].Max_depth = opt.level[bot];
+        for (int game; (game = next++) < opt.games;)
+        {
+            const bool a_color = game & 1;
+            const auto &opening = openings[game / 2];
+            for (auto &bot : bots)
+                bot.new_game();
+            Match match(a_color ? &bots[1] : &bots[0], a_color ? &bots[0] : &bots[1], opt.max_turns);
+            const match_result res = match.play(opening.first, opening.second);
+
+            lock_guard<mutex> lock(out_mtx);
+            out << game_to_json(game, a_color, opening.second, res).dump() << "\n";
+            if (res.winner == -1)
+                ++draws;
+            else if (res.winner == a_color)
+                ++wins;
+            else
+                ++losses;
+            for (int color = 0; color < 2; ++color)
+            {
+                const int bot = color != a_color;
+                for (const auto &move : res.moves[color])
+                    total_ms[bot] += move.ms;
+                moves[bot] += res.moves[color].size();
+            }
+        }
+    };
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int i = 1; i < opt.jobs; ++i)
+        workers.emplace_back(worker);
+    worker();
+    for (auto &w : workers)
+        w.join();
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    double error;
+    const double elo = elo_difference(wins, draws, losses, error);
+    const int played = wins + draws + losses;
+    const json summary = {{"games", played},
+                          {"a_wins", wins},
+                          {"draws", draws},
+                          {"b_wins", losses},
+                          {"a_score", played ? (wins + 0.5 * draws) / played : 0},
+                          {"elo", elo},
+                          {"elo_error", error},
+                          {"a_ms_per_move", moves[0] ? total_ms[0] / moves[0] : 0},
+                          {"b_ms_per_move", moves[1] ? total_ms[1] / moves[1] : 0},
+                          {"seconds", seconds}};
+    out << json{{"summary", summary}}.dump() << "\n";
+    // Краткий итог для человека - в stderr, чтобы не смешиваться с JSON в stdout
+    cerr << "A vs B: +" << wins << " =" << draws << " -" << losses << ", elo " << elo << " +- " << error << ", "
+         << seconds << " s\n";
+    return 0;
+}
@@ -0,0 +1,198 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "../Game/Position.h"
+#include "../Models/Project_path.h"
+
+// Параметры запуска perft
+struct perft_options
+{
+    string reference_path = project_path + "Tools/perft_reference.txt"; // Позиции с эталонными числами
+    string fen;        // Одна позиция вместо набора эталонов
+    int depth = 6;     // Глубина для --fen
+    int max_depth = 0; // Предел глубины проверки эталонов (0 - все записанные глубины)
+    int threads = 1;   // Потоки, делящие между собой ходы корня
+    bool divide = false; // Для --fen печатать число листьев после каждого хода корня
+};
+
+void print_usage()
+{
+    cerr << "usage: perft [options]\n"
+            "  --reference PATH  positions with reference counts (default Tools/perft_reference.txt)\n"
+            "  --max-depth N     check reference counts only up to depth N\n"
+            "  --fen FEN         count a single position instead, e.g. W:W21,22,K30:B1,2,K3\n"
+            "  --depth N         depth for --fen (default 6)\n"
+            "  --divide          with --fen print the count after every root move\n"
+            "  --threads N       split root moves between N threads (default 1)\n";
+}
+
+bool parse_options(const int argc, char *argv[], perft_options &opt)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+            return false;
+        if (arg == "--divide")
+        {
+            opt.divide = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            cerr << "missing value for " << arg << "\n";
+            return false;
+        }
+        const string value = argv[++i];
+        if (arg == "--reference")
+            opt.reference_path = value;
+        else if (arg == "--max-depth")
+            opt.max_depth = atoi(value.c_str());
+        else if (arg == "--fen")
+            opt.fen = value;
+        else if (arg == "--depth")
+            opt.depth = max(1, atoi(value.c_str()));
+        else if (arg == "--threads")
+            opt.threads = max(1, atoi(value.c_str()));
+        else
+        {
+            cerr << "unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Число листьев после каждого хода корня; ходы корня разбираются потоками по общему счетчику
+vector<uint64_t> perft_divide(const Position &start, const bool color, const int depth, const int threads)
+{
+    Position pos = start;
+    move_list root;
+    pos.gen_moves(color, root);
+    vector<uint64_t> counts(root.size, 1);
+    if (depth == 1)
+        return counts;
+    atomic<int> next(0);
+    auto worker = [&]() {
+        Position local = start;
+        vector<move_list> moves(depth);
+        Position::undo_info undo;
+        for (int i; (i = next++) < root.size;)
+        {
+            local.do_move(root[i], undo);
+            counts[i] = perft(local, !color, depth - 1, moves.data());
+            local.undo_move(root[i], undo);
+        }
+    };
+    vector<thread> workers;
+    for (int i = 1; i < threads; ++i)
+        workers.emplace_back(worker);
+    worker();
+    for (auto &w : workers)
+        w.join();
+    return counts;
+}
+
+uint64_t perft_total(const Position &start, const bool color, const int depth, const int threads)
+{
+    uint64_t nodes = 0;
+    for (const uint64_t count : perft_divide(start, color, depth, threads))
+        nodes += count;
+    return nodes;
+}
+
+// Считает одну позицию и печатает строку отчета; возвращает число листьев
+uint64_t run_depth(const Position &pos, const bool color, const int depth, const int threads)
+{
+    const auto start = chrono::steady_clock::now();
+    const uint64_t nodes = perft_total(pos, color, depth, threads);
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "  depth " << depth << ": " << nodes << " nodes, " << seconds << " s, "
+         << uint64_t(seconds > 0 ? nodes / seconds : 0) << " nodes/sec";
+    return nodes;
+}
+
+int run_single(const perft_options &opt)
+{
+    Position pos;
+    bool color;
+    if (!Position::from_fen(opt.fen, pos, color))
+    {
+        cerr << "bad position " << opt.fen << "\n";
+        return 1;
+    }
+    cout << pos.to_fen(color) << "\n";
+    if (opt.divide)
+    {
+        move_list root;
+        pos.gen_moves(color, root);
+        const vector<uint64_t> counts = perft_divide(pos, color, opt.depth, opt.threads);
+        for (int i = 0; i < root.size; ++i)
+            cout << "  " << move_notation(root[i]) << ": " << counts[i] << "\n";
+    }
+    for (int depth = 1; depth <= opt.depth; ++depth)
+    {
+        run_depth(pos, color, depth, opt.threads);
+        cout << "\n";
+    }
+    return 0;
+}
+
+// Набор эталонов: строки "позиция; n1 n2 n3 ...", где nk - число листьев на глубине k, # - комментарий
+int run_reference(const perft_options &opt)
+{
+    ifstream fin(opt.reference_path);
+    if (!fin)
+    {
+        cerr << "cannot read " << opt.reference_path << "\n";
+        return 1;
+    }
+    int checked = 0, failed = 0;
+    string line;
+    while (getline(fin, line))
+    {
+        if (line.empty() || line[0] == '#' || line[0] == '\r')
+            continue;
+        const size_t sep = line.find(';');
+        Position pos;
+        bool color;
+        if (sep == string::npos || !Position::from_fen(line.substr(0, sep), pos, color))
+        {
+            cerr << "bad reference line: " << line << "\n";
+            return 1;
+        }
+        cout << pos.to_fen(color) << "\n";
+        istringstream counts(line.substr(sep + 1));
+        uint64_t expected;
+        for (int depth = 1; counts >> expected && (!opt.max_depth || depth <= opt.max_depth); ++depth)
+        {
+            const uint64_t nodes = run_depth(pos, color, depth, opt.threads);
+            ++checked;
+            if (nodes == expected)
+                cout << " OK\n";
+            else
+            {
+                ++failed;
+                cout << " FAIL, expected " << expected << "\n";
+            }
+        }
+    }
+    cout << checked << " counts checked, " << failed << " failed\n";
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    perft_options opt;
+    if (!parse_options(argc, argv, opt))
+    {
+        print_usage();
+        return 1;
+    }
+    return opt.fen.empty() ? run_reference(opt) : run_single(opt);
+}
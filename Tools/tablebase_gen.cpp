@@ -0,0 +1,249 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <thread>
+
+#include "../Game/Tablebase.h"
+#include "../Models/Project_path.h"
+
+// Параметры генерации таблиц
+struct tablebase_options
+{
+    int pieces = 4;                                   // Наибольшее число дамок на доске
+    int jobs = max(1, int(thread::hardware_concurrency())); // Потоки анализа (по умолчанию - все ядра)
+    string out = project_path + "tablebases/";        // Папка для файлов таблиц
+};
+
+void print_usage()
+{
+    cerr << "usage: tablebase_gen [options]\n"
+            "  --pieces N  build all kings-only tables with up to N kings (default 4, at most "
+         << TB_MAX_PIECES
+         << ")\n"
+            "  --jobs N    analysis threads (default all cores)\n"
+            "  --out DIR   folder for the table files, must exist (default tablebases/)\n";
+}
+
+bool parse_options(const int argc, char *argv[], tablebase_options &opt)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+            return false;
+        if (i + 1 >= argc)
+        {
+            cerr << "missing value for " << arg << "\n";
+            return false;
+        }
+        const string value = argv[++i];
+        if (arg == "--pieces")
+            opt.pieces = min(max(2, atoi(value.c_str())), TB_MAX_PIECES);
+        else if (arg == "--jobs")
+            opt.jobs = max(1, atoi(value.c_str()));
+        else if (arg == "--out")
+        {
+            opt.out = value;
+            if (!opt.out.empty() && opt.out.back() != '/' && opt.out.back() != '\\')
+                opt.out += '/';
+        }
+        else
+        {
+            cerr << "unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Готовые таблицы в памяти: [дамки стороны, делающей ход][дамки соперника]
+typedef map<pair<int, int>, vector<uint8_t>> table_set;
+
+/**
+ * Ретроградный анализ пары таблиц (mover, other) и (other, mover): ход в одной из них без взятия
+ * ведет в другую, взятие - в уже готовую таблицу с меньшим числом фигур.
+ * Сначала каждая позиция проверяется прямым перебором ходов (потоки делят позиции между собой):
+ * позиция без ходов проиграна, позиция со взятием решается по готовым таблицам, а у остальных
+ * запоминается число еще не решенных ходов. Дальше решенные позиции разбираются по возрастанию
+ * расстояния, и значение передается предшественникам (обратные ходы - отход дамки соперника по лучу):
+ * проигрыш делает предшественника выигрышем на ход дальше, а выигрыш уменьшает его счетчик,
+ * и позиция, все ходы которой ведут к выигрышу соперника, проиграна за самый долгий из них.
+ * Позиции, оставшиеся нерешенными, - ничьи
+ */
+bool solve_pair(const int mover, const int other, table_set &tables, const int jobs)
+{
+    const pair<int, int> keys[2] = {{mover, other}, {other, mover}};
+    const int pair_size = mover == other ? 1 : 2;
+    // Число нерешенных ходов позиции; 0 - значение позиции окончательное
+    vector<uint8_t> pending[2];
+    // Решенные позиции (номер таблицы в паре, индекс) по расстоянию до конца партии
+    vector<vector<pair<int, uint32_t>>> by_plies(256);
+
+    for (int t = 0; t < pair_size; ++t)
+    {
+        const int mover_count = keys[t].first, other_count = keys[t].second;
+        const uint64_t size = tb_size(mover_count, other_count);
+        vector<uint8_t> &table = tables[keys[t]];
+        table.assign(size, 0);
+        pending[t].assign(size, 0);
+        atomic<uint64_t> next(0);
+        auto worker = [&]() {
+            const uint64_t CHUNK = 4096;
+            move_list moves;
+            Position::undo_info undo;
+            for (uint64_t begin; (begin = next.fetch_add(CHUNK)) < size;)
+            {
+                for (uint64_t i = begin; i < min(begin + CHUNK, size); ++i)
+                {
+                    Position pos;
+                    tb_unindex(i, mover_count, other_count, pos.white, pos.black);
+                    pos.kings = pos.white | pos.black;
+                    pos.rehash();
+                    // Ходы без взятия остаются в паре: их значения найдет обратный анализ
+                    if (!pos.gen_moves(0, moves) && !moves.empty())
+                    {
+                        pending[t][i] = uint8_t(moves.size);
+                        continue;
+                    }
+                    // Нет ходов - проигрыш; взятие ведет в готовую таблицу или оставляет соперника без фигур
+                    int win = -1, loss = moves.empty() ? 0 : -1;
+                    bool draw = false;
+                    for (const auto &turn : moves)
+                    {
+                        pos.do_move(turn, undo);
+                        const pair<int, int> key(bit_count(pos.black), bit_count(pos.white));
+                        const uint8_t value = key.first ? tables.at(key)[tb_index(pos.black, pos.white)] : 1;
+                        pos.undo_move(turn, undo);
+                        if (tb_loss(value))
+                            win = win < 0 ? tb_plies(value) + 1 : min(win, tb_plies(value) + 1);
+                        else if (tb_win(value))
+                            loss = max(loss, tb_plies(value) + 1);
+                        else
+                            draw = true;
+                    }
+                    table[i] = win >= 0 ? uint8_t(win + 1) : draw ? 0 : uint8_t(loss + 1);
+                }
+            }
+        };
+        vector<thread> workers;
+        for (int j = 1; j < jobs; ++j)
+            workers.emplace_back(worker);
+        worker();
+        for (auto &w : workers)
+            w.join();
+        for (uint64_t i = 0; i < size; ++i)
+            if (!pending[t][i] && table[i])
+                by_plies[tb_plies(table[i])].emplace_back(t, uint32_t(i));
+    }
+
+    // Позиции с расстоянием d решают предшественников за d + 1: разбор по возрастанию d дает
+    // самый быстрый выигрыш и самую долгую защиту
+    for (int d = 0; d < int(by_plies.size()); ++d)
+    {
+        for (size_t k = 0; k < by_plies[d].size(); ++k)
+        {
+            const int t = by_plies[d][k].first;
+            const int prev_t = pair_size == 1 ? 0 : 1 - t;
+            const bool lost = tb_loss(tables[keys[t]][by_plies[d][k].second]);
+            BB own, opp;
+            tb_unindex(by_plies[d][k].second, keys[t].first, keys[t].second, own, opp);
+            const BB free = ~(own | opp);
+            vector<uint8_t> &prev_table = tables[keys[prev_t]];
+            // Предшественник: ходил соперник, одна из его дамок пришла по лучу с клетки from
+            for (BB b = opp; b; b &= b - 1)
+            {
+                const BB king = BB(1) << bit_first(b);
+                for (int dir = 0; dir < 4; ++dir)
+                {
+                    for (BB from = shift(king, dir); from & free; from = shift(from, dir))
+                    {
+                        const uint64_t index = tb_index(opp ^ king ^ from, own);
+                        uint8_t &count = pending[prev_t][index];
+                        if (!count)
+                            continue;
+                        if (lost)
+                            count = 0;
+                        else if (--count)
+                            continue;
+                        if (d + 1 > 254)
+                        {
+                            cerr << "distance does not fit in a byte\n";
+                            return false;
+                        }
+                        prev_table[index] = uint8_t(d + 2);
+                        by_plies[d + 1].emplace_back(prev_t, uint32_t(index));
+                    }
+                }
+            }
+        }
+        vector<pair<int, uint32_t>>().swap(by_plies[d]);
+    }
+    return true;
+}
+
+bool write_table(const string &dir, const int mover, const int other, const vector<uint8_t> &values)
+{
+    tb_header header;
+    memcpy(header.magic, TB_MAGIC, sizeof(TB_MAGIC));
+    header.mover = uint8_t(mover);
+    header.other = uint8_t(other);
+    header.version = TB_VERSION;
+    header.count = uint32_t(values.size());
+    const string path = dir + tb_file_name(mover, other);
+    ofstream fout(path, ios::binary);
+    fout.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    fout.write(reinterpret_cast<const char *>(values.data()), streamsize(values.size()));
+    if (!fout)
+    {
+        cerr << "cannot write " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    tablebase_options opt;
+    if (!parse_options(argc, argv, opt))
+    {
+        print_usage();
+        return 1;
+    }
+    // Таблицы строятся по возрастанию числа фигур: взятия ведут только в готовые таблицы
+    table_set tables;
+    for (int total = 2; total <= opt.pieces; ++total)
+    {
+        for (int mover = total - 1; mover >= (total + 1) / 2; --mover)
+        {
+            const int other = total - mover;
+            const auto start = chrono::steady_clock::now();
+            if (!solve_pair(mover, other, tables, opt.jobs))
+                return 1;
+            const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            for (int t = 0; t < (mover == other ? 1 : 2); ++t)
+            {
+                const pair<int, int> key = t ? make_pair(other, mover) : make_pair(mover, other);
+                const vector<uint8_t> &values = tables[key];
+                uint64_t wins = 0, losses = 0, draws = 0;
+                int longest = 0;
+                for (const uint8_t value : values)
+                {
+                    wins += tb_win(value);
+                    losses += tb_loss(value);
+                    draws += !value;
+                    if (tb_win(value))
+                        longest = max(longest, tb_plies(value));
+                }
+                if (!write_table(opt.out, key.first, key.second, values))
+                    return 1;
+                cout << tb_file_name(key.first, key.second) << ": " << values.size() << " positions, " << wins
+                     << " wins, " << losses << " losses, " << draws << " draws, longest win " << longest
+                     << " moves, " << seconds << " s\n";
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,199 @@
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "../Game/Match.h"
+#include "bot_config.h"
+
+// Параметры турнира
+struct tournament_options
+{
+    string config_path[2] = {project_path + "settings.json", project_path + "settings.json"}; // Настройки ботов A и B
+    vector<string> overrides[2]; // Переопределения "Раздел.Параметр=значение"
+    int level[2] = {-1, -1};     // Уровень ботов (-1 - BlackBotLevel из их настроек)
+    int max_games = 20000;       // Предел числа партий, если тест не закончился раньше
+    int plies = 4;               // Длина дебютов набора
+    unsigned seed = 1;           // Seed перемешивания набора дебютов
+    int jobs = max(1, int(thread::hardware_concurrency())); // Партий одновременно (по умолчанию - все ядра)
+    int max_turns = -1;          // Предел ходов до ничьей (-1 - MaxNumTurns из настроек бота A)
+    double elo0 = 0, elo1 = 10;  // Гипотезы SPRT: H0 - A сильнее B на elo0, H1 - на elo1
+    double alpha = 0.05, beta = 0.05; // Допустимые вероятности ошибок первого и второго рода
+    int report = 100;            // Печатать промежуточный итог каждые report партий
+};
+
+void print_usage()
+{
+    cerr << "usage: tournament [options]\n"
+            "  --a PATH, --b PATH        settings of bot A / bot B (default settings.json)\n"
+            "  --set-a KEY=VALUE         override a setting of bot A, KEY is Section.Name, e.g. Bot.Optimization=O2\n"
+            "  --set-b KEY=VALUE         the same for bot B (both can be repeated)\n"
+            "  --level-a N, --level-b N  bot level (default Bot.BlackBotLevel of its settings)\n"
+            "  --elo0 X, --elo1 X        SPRT hypotheses: A is stronger than B by elo0 (H0) or elo1 (H1), default 0 "
+            "and 10\n"
+            "  --alpha X, --beta X       SPRT error probabilities (default 0.05)\n"
+            "  --max-games N             stop after N games if the test is still running (default 20000)\n"
+            "  --plies N                 openings are all distinct positions after N plies (default 4)\n"
+            "  --seed N                  seed of the opening order (default 1)\n"
+            "  --jobs N                  games played in parallel (default all cores)\n"
+            "  --max-turns N             turns before a draw (default Game.MaxNumTurns of bot A)\n"
+            "  --report N                print the running result every N games (default 100)\n";
+}
+
+bool parse_options(const int argc, char *argv[], tournament_options &opt)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const string arg = argv[i];
+        if (arg == "--help" || arg == "-h")
+            return false;
+        if (i + 1 >= argc)
+        {
+            cerr << "missing value for " << arg << "\n";
+            return false;
+        }
+        const string value = argv[++i];
+        if (arg == "--a" || arg == "--b")
+            opt.config_path[arg == "--b"] = value;
+        else if (arg == "--set-a" || arg == "--set-b")
+            opt.overrides[arg == "--set-b"].push_back(value);
+        else if (arg == "--level-a" || arg == "--level-b")
+            opt.level[arg == "--level-b"] = atoi(value.c_str());
+        else if (arg == "--elo0")
+            opt.elo0 = atof(value.c_str());
+        else if (arg == "--elo1")
+            opt.elo1 = atof(value.c_str());
+        else if (arg == "--alpha")
+            opt.alpha = atof(value.c_str());
+        else if (arg == "--beta")
+            opt.beta = atof(value.c_str());
+        else if (arg == "--max-games")
+            opt.max_games = atoi(value.c_str());
+        else if (arg == "--plies")
+            opt.plies = atoi(value.c_str());
+        else if (arg == "--seed")
+            opt.seed = unsigned(atoi(value.c_str()));
+        else if (arg == "--jobs")
+            opt.jobs = max(1, atoi(value.c_str()));
+        else if (arg == "--max-turns")
+            opt.max_turns = atoi(value.c_str());
+        else if (arg == "--report")
+            opt.report = max(1, atoi(value.c_str()));
+        else
+        {
+            cerr << "unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Текущий итог турнира с точки зрения бота A
+struct tournament_state
+{
+    int wins = 0, draws = 0, losses = 0;
+    double llr = 0;
+    int verdict = 0; // 1 - принята H1, -1 - принята H0, 0 - тест не закончен
+
+    int games() const
+    {
+        return wins + draws + losses;
+    }
+};
+
+void print_state(ostream &out, const tournament_state &state, const double lower, const double upper)
+{
+    double error;
+    const double elo = elo_difference(state.wins, state.draws, state.losses, error);
+    out << "games " << state.games() << ": +" << state.wins << " =" << state.draws << " -" << state.losses
+        << ", elo " << elo << " +- " << error << ", LLR " << state.llr << " [" << lower << ", " << upper << "]\n";
+}
+
+int main(int argc, char *argv[])
+{
+    tournament_options opt;
+    if (!parse_options(argc, argv, opt))
+    {
+        print_usage();
+        return 1;
+    }
+    unique_ptr<Config> configs[2];
+    for (int bot = 0; bot < 2; ++bot)
+    {
+        if (!load_bot_config(opt.config_path[bot], opt.overrides[bot], configs[bot]))
+            return 1;
+        if (opt.level[bot] == -1)
+            opt.level[bot] = (*configs[bot])("Bot", "BlackBotLevel");
+    }
+    if (opt.max_turns == -1)
+        opt.max_turns = (*configs[0])("Game", "MaxNumTurns");
+
+    // Набор дебютов в случайном порядке; каждый дебют играется парой партий со сменой цветов
+    vector<Position> suite = opening_suite(opt.plies);
+    shuffle(suite.begin(), suite.end(), mt19937(opt.seed));
+    const bool first_color = opt.plies & 1;
+
+    // Границы SPRT: LLR ниже lower - принимается H0, выше upper - H1
+    const double lower = log(opt.beta / (1 - opt.alpha)), upper = log((1 - opt.beta) / opt.alpha);
+    cerr << suite.size() << " openings, " << opt.jobs << " jobs, SPRT elo0 " << opt.elo0 << " elo1 " << opt.elo1
+         << "\n";
+
+    atomic<int> next(0);
+    atomic<bool> finished(false);
+    mutex state_mtx;
+    tournament_state state;
+    auto worker = [&]() {
+        // У каждого потока свои экземпляры Logic: боты не разделяют таблицы и буферы
+        Logic bots[2] = {Logic(configs[0].get()), Logic(configs[1].get())};
+        for (int bot = 0; bot < 2; ++bot)
+            bots[bot].Max_depth = opt.level[bot];
+        for (int game; !finished && (game = next++) < opt.max_games;)
+        {
+            const bool a_color = game & 1;
+            const Position &opening = suite[(game / 2) % suite.size()];
+            for (auto &bot : bots)
+                bot.new_game();
+            Match match(a_color ? &bots[1] : &bots[0], a_color ? &bots[0] : &bots[1], opt.max_turns);
+            const match_result res = match.play(opening, first_color);
+
+            lock_guard<mutex> lock(state_mtx);
+            if (state.verdict)
+                break;
+            if (res.winner == -1)
+                ++state.draws;
+            else if (res.winner == a_color)
+                ++state.wins;
+            else
+                ++state.losses;
+            state.llr = sprt_llr(state.wins, state.draws, state.losses, opt.elo0, opt.elo1);
+            if (state.llr >= upper)
+                state.verdict = 1;
+            else if (state.llr <= lower)
+                state.verdict = -1;
+            if (state.verdict)
+                finished = true;
+            if (state.games() % opt.report == 0)
+                print_state(cerr, state, lower, upper);
+        }
+    };
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int i = 1; i < opt.jobs; ++i)
+        workers.emplace_back(worker);
+    worker();
+    for (auto &w : workers)
+        w.join();
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    print_state(cout, state, lower, upper);
+    if (state.verdict == 1)
+        cout << "H1 accepted: A is stronger than B by about " << opt.elo1 << " elo or more\n";
+    else if (state.verdict == -1)
+        cout << "H0 accepted: A is not stronger than B by " << opt.elo1 << " elo (about " << opt.elo0
+             << " or less)\n";
+    else
+        cout << "inconclusive after " << state.games() << " games\n";
+    cout << "time " << seconds << " s\n";
+    return 0;
+}